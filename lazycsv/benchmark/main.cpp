@@ -0,0 +1,330 @@
+// throughput benchmark on generated csv files, e.g. `lazycsv_benchmark --size 1M,1G --dataset wide_quoted --repeat 5`
+
+#include <lazycsv.hpp>
+#if defined(LAZYCSV_BENCHMARK_CISTA)
+#include <lazycsv_cista.hpp>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/stat.h>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace
+{
+struct dataset
+{
+    const char* name;
+    std::size_t columns;
+    bool numeric;
+    bool quoted;
+};
+
+// narrow and wide files of numbers or text, half of the quoted text cells have delimiters or escaped quotes inside
+const dataset datasets[] = {
+    { "narrow_numeric", 4, true, false }, { "narrow_text", 4, false, false },  { "narrow_quoted", 4, false, true },
+    { "wide_numeric", 120, true, false }, { "wide_text", 120, false, false }, { "wide_quoted", 120, false, true },
+};
+
+struct options
+{
+    std::vector<std::uint64_t> sizes{ 1 << 20, 64 << 20 };
+    std::vector<std::string> datasets;
+    std::string directory{ "." };
+    int repeat{ 3 };
+};
+
+std::uint64_t parse_size(const std::string& text)
+{
+    std::size_t suffix = 0;
+    auto size = std::stoull(text, &suffix);
+    for (const auto unit : text.substr(suffix))
+    {
+        if (unit == 'K' || unit == 'k')
+            size <<= 10;
+        else if (unit == 'M' || unit == 'm')
+            size <<= 20;
+        else if (unit == 'G' || unit == 'g')
+            size <<= 30;
+    }
+    return size;
+}
+
+std::vector<std::string> split(const std::string& text)
+{
+    std::vector<std::string> parts;
+    for (std::size_t begin = 0; begin <= text.size();)
+    {
+        const auto end = std::min(text.find(',', begin), text.size());
+        parts.push_back(text.substr(begin, end - begin));
+        begin = end + 1;
+    }
+    return parts;
+}
+
+// the output is deterministic, files are generated once and reused by later runs
+std::string generate(const dataset& set, std::uint64_t size, const std::string& directory)
+{
+    const auto path = directory + "/lazycsv_" + set.name + "_" + std::to_string(size) + ".csv";
+    struct stat status;
+    if (::stat(path.c_str(), &status) == 0 && static_cast<std::uint64_t>(status.st_size) >= size)
+        return path;
+
+    std::mt19937_64 random{ 42 };
+    const auto word = [&](std::string& output)
+    {
+        const auto length = 3 + random() % 10;
+        for (std::uint64_t i = 0; i < length; i++)
+            output.push_back(static_cast<char>('a' + random() % 26));
+    };
+
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file)
+        throw std::runtime_error{ "Can't create " + path };
+
+    std::string row;
+    for (std::size_t column = 0; column < set.columns; column++)
+        row += "column" + std::to_string(column) + (column + 1 < set.columns ? "," : "\n");
+
+    std::uint64_t written = 0;
+    while (written < size)
+    {
+        written += std::fwrite(row.data(), 1, row.size(), file);
+        row.clear();
+        for (std::size_t column = 0; column < set.columns; column++)
+        {
+            if (set.numeric)
+                row += column % 2 ? std::to_string(random() % 1000000) : std::to_string((random() % 10000000) / 100.0);
+            else if (set.quoted && random() % 2)
+            {
+                row.push_back('"');
+                word(row);
+                row += random() % 2 ? ", " : "\"\"";
+                word(row);
+                row.push_back('"');
+            }
+            else
+                word(row);
+            row.push_back(column + 1 < set.columns ? ',' : '\n');
+        }
+    }
+    std::fclose(file);
+    return path;
+}
+
+// cpu cycles from perf events when they are accessible, otherwise time stamp counter ticks
+// the counter inherits into threads started after it is opened, their cycles are added once they exit,
+// so multithreaded benchmarks must join their workers before returning
+class cycle_counter
+{
+    int fd_{ -1 };
+
+  public:
+    cycle_counter()
+    {
+#if defined(__linux__)
+        perf_event_attr attributes{};
+        attributes.type = PERF_TYPE_HARDWARE;
+        attributes.size = sizeof(attributes);
+        attributes.config = PERF_COUNT_HW_CPU_CYCLES;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        attributes.inherit = 1;
+        fd_ = static_cast<int>(::syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+#endif
+    }
+
+    ~cycle_counter()
+    {
+        if (fd_ != -1)
+            ::close(fd_);
+    }
+
+    cycle_counter(const cycle_counter&) = delete;
+    cycle_counter& operator=(const cycle_counter&) = delete;
+
+    const char* unit() const
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        return fd_ != -1 ? "cycles/B" : "ticks/B";
+#else
+        return fd_ != -1 ? "cycles/B" : "-";
+#endif
+    }
+
+    std::uint64_t now() const
+    {
+        std::uint64_t cycles = 0;
+        if (fd_ != -1 && ::read(fd_, &cycles, sizeof(cycles)) == sizeof(cycles))
+            return cycles;
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return 0;
+#endif
+    }
+};
+
+struct benchmark
+{
+    const char* name;
+    std::function<std::uint64_t(const lazycsv::parser<>&)> run;
+    bool numeric{ false }; // only runs on numeric datasets
+};
+
+template<class parser>
+std::uint64_t last_column_of(const parser& csv)
+{
+    std::uint64_t columns = 0;
+    for (const auto cell : csv.header())
+    {
+        static_cast<void>(cell);
+        columns++;
+    }
+    return columns - 1;
+}
+
+const benchmark benchmarks[] = {
+    { "rows",
+      [](const lazycsv::parser<>& csv)
+      {
+          std::uint64_t sum = 0;
+          for (const auto row : csv)
+              sum += row.raw().size();
+          return sum;
+      } },
+    { "cells",
+      [](const lazycsv::parser<>& csv)
+      {
+          std::uint64_t sum = 0;
+          for (const auto row : csv)
+              for (const auto cell : row)
+                  sum += cell.raw().size();
+          return sum;
+      } },
+    { "cells()",
+      [](const lazycsv::parser<>& csv)
+      {
+          const auto last = static_cast<int>(last_column_of(csv));
+          std::uint64_t sum = 0;
+          for (const auto row : csv)
+          {
+              const auto [first, middle, back] = row.cells(0, last / 2, last);
+              sum += first.raw().size() + middle.raw().size() + back.raw().size();
+          }
+          return sum;
+      } },
+    { "unescaped()",
+      [](const lazycsv::parser<>& csv)
+      {
+          std::uint64_t sum = 0;
+          for (const auto row : csv)
+              for (const auto cell : row)
+                  sum += cell.unescaped().view().size();
+          return sum;
+      } },
+    // sums of column0 grouped by column1, single threaded baseline
+    { "naive group",
+      [](const lazycsv::parser<>& csv)
+      {
+          std::unordered_map<std::string_view, double> groups;
+          for (const auto row : csv)
+          {
+              const auto [value, key] = row.cells(0, 1);
+              groups[key.trimed()] += value.as<double>().value;
+          }
+          return static_cast<std::uint64_t>(groups.size());
+      },
+      true },
+#if defined(LAZYCSV_BENCHMARK_CISTA)
+    { "group_by",
+      [](const lazycsv::parser<>& csv) { return static_cast<std::uint64_t>(lazycsv::group_by(csv, "column1", "column0").groups.size()); },
+      true },
+#endif
+};
+} // namespace
+
+int main(int argc, char** argv)
+{
+    options settings;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        const std::string option = argv[i];
+        if (option == "--size")
+        {
+            settings.sizes.clear();
+            for (const auto& size : split(argv[i + 1]))
+                settings.sizes.push_back(parse_size(size));
+        }
+        else if (option == "--dataset")
+            settings.datasets = split(argv[i + 1]);
+        else if (option == "--dir")
+            settings.directory = argv[i + 1];
+        else if (option == "--repeat")
+            settings.repeat = std::max(1, std::stoi(argv[i + 1]));
+        else
+        {
+            std::cerr << "usage: " << argv[0] << " [--size 1M,64M,10G] [--dataset name,...] [--dir path] [--repeat n]\n";
+            return 1;
+        }
+    }
+
+    const cycle_counter counter;
+    std::printf("%-16s %10s %-12s %10s %10s\n", "dataset", "size", "benchmark", "GB/s", counter.unit());
+    for (const auto& set : datasets)
+    {
+        if (!settings.datasets.empty() &&
+            std::find(settings.datasets.begin(), settings.datasets.end(), set.name) == settings.datasets.end())
+            continue;
+
+        for (const auto size : settings.sizes)
+        {
+            const auto path = generate(set, size, settings.directory);
+            const lazycsv::parser<> csv{ path, lazycsv::mmap_options{ lazycsv::access_pattern::sequential } };
+            const auto bytes = static_cast<double>(csv.data_source().size());
+            for (const auto& bench : benchmarks)
+            {
+                if (bench.numeric && !set.numeric)
+                    continue;
+                volatile std::uint64_t sink = bench.run(csv); // warms the page cache
+                auto best_seconds = 1e300;
+                auto best_cycles = ~std::uint64_t{ 0 };
+                for (int i = 0; i < settings.repeat; i++)
+                {
+                    const auto start = std::chrono::steady_clock::now();
+                    const auto start_cycles = counter.now();
+                    sink = bench.run(csv);
+                    const auto cycles = counter.now() - start_cycles;
+                    const std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+                    best_seconds = std::min(best_seconds, seconds.count());
+                    best_cycles = std::min(best_cycles, cycles);
+                }
+                static_cast<void>(sink);
+                std::printf("%-16s %10llu %-12s %10.3f %10.3f\n",
+                            set.name,
+                            static_cast<unsigned long long>(size),
+                            bench.name,
+                            bytes / best_seconds / 1e9,
+                            best_cycles / bytes);
+            }
+        }
+    }
+}
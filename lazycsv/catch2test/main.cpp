@@ -1,4 +1,7 @@
 #include "include/lazycsv.hpp"
+#if __has_include(<cista/serialization.h>)
+#include "include/lazycsv_cista.hpp"
+#endif
 
 #include <catch2/catch_test_macros.hpp>
 
@@ -144,3 +147,808 @@ TEST_CASE("Parser quoted cells", "[parser]")
     auto [b3] = row_3->cells(1);
     REQUIRE("\"B3\"" == b3.unescaped());
 }
+
+TEST_CASE("SIMD chunk cells matches scalar chunk cells", "[chunk_cells]")
+{
+    std::string row;
+    for (auto i = 0; i < 40; i++)
+        row += std::string(i, 'x') + (i % 3 ? "," : "\"q,\"\"" + std::string(i * 2, ',') + "\",");
+
+    using scalar = lazycsv::detail::chunk_cells<',', '"'>;
+    using simd = lazycsv::detail::simd_chunk_cells<',', '"'>;
+    const auto* dead_end = row.data() + row.size();
+    for (const auto* begin = row.data(); begin < dead_end; begin++)
+        REQUIRE(scalar::chunk(begin, dead_end) == simd::chunk(begin, dead_end));
+}
+
+TEST_CASE("Parser long quoted cells", "[parser]")
+{
+    const auto long_cell = std::string(70, 'A') + "," + std::string(70, 'B');
+    lazycsv::parser<std::string, lazycsv::has_header<false>> parser{ "\"" + long_cell + "\"," + std::string(100, 'C') + "\n" };
+    check_rows(parser, { { long_cell, std::string(100, 'C') } });
+}
+
+TEST_CASE("Parser quoted newlines with multiline cells", "[parser]")
+{
+    using multiline_parser = lazycsv::parser<
+        std::string,
+        lazycsv::has_header<false>,
+        lazycsv::delimiter<','>,
+        lazycsv::quote_char<'"'>,
+        lazycsv::trim_chars<' ', '\t'>,
+        lazycsv::multiline_cells<true>>;
+
+    const auto long_cell = std::string(70, 'A') + "\n\n" + std::string(70, 'B');
+    multiline_parser parser{ "A0,\"B\n0\",C0\n\"A1\"\"\n\",B1,C1\nA2,B2,\"C\n\n2\"\n\"" + long_cell + "\",B3\n" };
+    check_rows(parser, { { "A0", "B\n0", "C0" }, { "A1\"\"\n", "B1", "C1" }, { "A2", "B2", "C\n\n2" }, { long_cell, "B3" } });
+}
+
+template<class T>
+void check_shards(const T& parser)
+{
+    std::vector<std::string_view> expected_rows;
+    for (const auto row : parser)
+        expected_rows.push_back(row.raw());
+
+    for (std::size_t count = 1; count <= 8; count++)
+    {
+        std::vector<std::string_view> rows;
+        for (const auto& shard : parser.shards(count))
+        {
+            for (const auto row : shard)
+                rows.push_back(row.raw());
+        }
+        REQUIRE(expected_rows == rows);
+    }
+}
+
+TEST_CASE("Parser shards", "[parser]")
+{
+    check_shards(lazycsv::parser{ "inputs/basic.csv" });
+    check_shards(lazycsv::parser<std::string, lazycsv::has_header<false>>{ "A0\nA1,B1\n\nA3\nA4,B4,C4,D4" });
+    check_shards(lazycsv::parser<std::string, lazycsv::has_header<false>>{ "A0\n" });
+    REQUIRE(lazycsv::parser{ "inputs/zero_length.csv" }.shards(4).empty());
+}
+
+TEST_CASE("Parser shards with multiline cells", "[parser]")
+{
+    using multiline_parser = lazycsv::parser<
+        std::string,
+        lazycsv::has_header<true>,
+        lazycsv::delimiter<','>,
+        lazycsv::quote_char<'"'>,
+        lazycsv::trim_chars<' ', '\t'>,
+        lazycsv::multiline_cells<true>>;
+
+    const auto long_cell = "\"" + std::string(70, '\n') + "\"\"" + std::string(70, '\n') + "\"";
+    check_shards(multiline_parser{ "A,B\n\"\n\n\",B0\nA1,\"\"\"\nB1\"\n" + long_cell + ",B2\n\n\"\n\",\"\n\"\nA5" });
+    check_shards(multiline_parser{ "A,B\nA0,\"B0\n" }); // unclosed quote
+}
+
+template<class T>
+void check_indexed_rows(T& parser)
+{
+    std::vector<std::string_view> expected_rows;
+    for (const auto row : parser)
+        expected_rows.push_back(row.raw());
+
+    REQUIRE(expected_rows.size() == parser.row_count());
+    for (std::size_t i = 0; i < expected_rows.size(); i++)
+        REQUIRE(expected_rows[i] == parser.row_at(i).raw());
+    REQUIRE_THROWS(parser.row_at(expected_rows.size()));
+
+    const auto rows = parser.indexed_rows();
+    REQUIRE(std::distance(rows.begin(), rows.end()) == static_cast<std::ptrdiff_t>(expected_rows.size()));
+    for (auto it = rows.end(); it != rows.begin();)
+    {
+        --it;
+        REQUIRE(expected_rows[it - rows.begin()] == it->raw());
+    }
+}
+
+TEST_CASE("Parser row index", "[row_index]")
+{
+    lazycsv::parser parser{ "inputs/basic.csv" };
+    REQUIRE(parser.row_count() == 0);
+    REQUIRE_THROWS(parser.row_at(0));
+    parser.build_index();
+    check_indexed_rows(parser);
+
+    std::string csv;
+    for (auto i = 0; i < 1000; i++)
+        csv += std::string(i % 7 ? i % 13 : i * 3, 'A') + "," + std::to_string(i) + (i % 100 ? "\n" : "\n\n");
+    lazycsv::parser<std::string, lazycsv::has_header<false>> long_parser{ csv };
+    long_parser.build_index();
+    check_indexed_rows(long_parser);
+
+    lazycsv::parser<std::string, lazycsv::has_header<false>> parser_without_last_new_line{ "A0\n\nA2" };
+    parser_without_last_new_line.build_index();
+    check_indexed_rows(parser_without_last_new_line);
+}
+
+TEST_CASE("Parser persisted row index", "[row_index]")
+{
+    std::remove("basic.csv.index");
+
+    lazycsv::parser parser{ "inputs/basic.csv" };
+    parser.build_index("basic.csv.index");
+    check_indexed_rows(parser);
+
+    lazycsv::parser reopened_parser{ "inputs/basic.csv" };
+    reopened_parser.build_index("basic.csv.index");
+    REQUIRE(reopened_parser.index().fingerprint() == parser.index().fingerprint());
+    check_indexed_rows(reopened_parser);
+
+    lazycsv::parser<std::string> other_parser{ "A,B\nA0,B0\n" };
+    other_parser.build_index("basic.csv.index");
+    check_indexed_rows(other_parser);
+
+    lazycsv::parser<lazycsv::mmap_source, lazycsv::has_header<false>> headerless_parser{ "inputs/basic.csv" };
+    headerless_parser.build_index("basic.csv.index");
+    REQUIRE(headerless_parser.index().dialect() != parser.index().dialect());
+    REQUIRE(headerless_parser.row_count() == parser.row_count() + 1);
+    check_indexed_rows(headerless_parser);
+
+    std::string saved;
+    {
+        std::ifstream file{ "basic.csv.index", std::ios::binary };
+        saved.assign(std::istreambuf_iterator<char>{ file }, {});
+    }
+    const auto rewrite = [](const std::string& content) { std::ofstream{ "basic.csv.index", std::ios::binary } << content; };
+    REQUIRE(lazycsv::row_index::load("basic.csv.index"));
+
+    rewrite(saved.substr(0, saved.size() - 8));
+    REQUIRE_FALSE(lazycsv::row_index::load("basic.csv.index"));
+
+    auto huge_size = saved;
+    huge_size[15] = '\x7f'; // most significant byte of the row count
+    rewrite(huge_size);
+    REQUIRE_FALSE(lazycsv::row_index::load("basic.csv.index"));
+
+    auto extra_offsets = saved;
+    extra_offsets[saved.size() - 9] = '\xff'; // most significant byte of the last high bits word, before the samples
+    rewrite(extra_offsets);
+    REQUIRE_FALSE(lazycsv::row_index::load("basic.csv.index"));
+    headerless_parser.build_index("basic.csv.index");
+    check_indexed_rows(headerless_parser);
+
+    std::remove("basic.csv.index");
+}
+
+TEST_CASE("Parser tokenized row", "[tokenized_row]")
+{
+    lazycsv::parser<std::string, lazycsv::has_header<false>> parser{
+        "\"A0\"\"\",B0,C0,\n,\"B1,\",\"C1\",D1\n\n\"\",\",\",,\"D\"\"2\"\nA3, \"B3\" ,C3,\"\"\n"
+    };
+
+    decltype(parser)::tokenized_row tokens;
+    std::string wide_row;
+    for (auto i = 0; i < 100; i++)
+        wide_row += (i % 3 ? "\"C,ell\"" : std::to_string(i)) + std::string(i == 99 ? "" : ",");
+
+    for (const auto& csv : { parser, decltype(parser){ wide_row }, decltype(parser){ wide_row + "\n" + wide_row } })
+    {
+        for (const auto row : csv)
+        {
+            tokens.assign(row);
+            std::size_t index = 0;
+            for (const auto cell : row)
+                REQUIRE(cell.raw() == tokens[index++].raw());
+            REQUIRE(index == tokens.size());
+        }
+    }
+
+    const decltype(parser)::tokenized_row row_1{ *std::next(parser.begin()) };
+    const auto [d1, b1] = row_1.cells(3, 1);
+    REQUIRE("D1" == d1.raw());
+    REQUIRE("B1," == b1.raw());
+    REQUIRE_THROWS(row_1.at(4));
+}
+
+TEST_CASE("Parser indexes of", "[parser]")
+{
+    lazycsv::parser<std::string> parser{ "name, city ,\"age\"\nPeter,Quahog,45\n" };
+    const auto [age, name] = parser.indexes_of("age", "name");
+    REQUIRE(2 == age);
+    REQUIRE(0 == name);
+    REQUIRE(1 == parser.indexes_of("city")[0]);
+    REQUIRE_THROWS(parser.indexes_of("name", "phone"));
+}
+
+struct chunked_reader
+{
+    std::string data;
+    std::size_t chunk_size;
+    std::size_t position = 0;
+
+    std::size_t operator()(char* buffer, std::size_t size)
+    {
+        const auto read = std::min({ size, chunk_size, data.size() - position });
+        data.copy(buffer, read, position);
+        position += read;
+        return read;
+    }
+};
+
+template<class T>
+void check_stream(const std::string& csv)
+{
+    using stream_parser = lazycsv::stream_parser<
+        lazycsv::stream_source<chunked_reader>,
+        lazycsv::has_header<false>,
+        lazycsv::delimiter<','>,
+        lazycsv::quote_char<'"'>,
+        lazycsv::trim_chars<' ', '\t'>,
+        T>;
+    const lazycsv::parser<
+        std::string,
+        lazycsv::has_header<false>,
+        lazycsv::delimiter<','>,
+        lazycsv::quote_char<'"'>,
+        lazycsv::trim_chars<' ', '\t'>,
+        T>
+        parser{ csv };
+
+    for (const auto chunk_size : { 1, 3, 64, 1000 })
+    {
+        for (const auto capacity : { 4, 16, 4096 })
+        {
+            stream_parser stream{ chunked_reader{ csv, static_cast<std::size_t>(chunk_size) }, capacity };
+            auto expected = parser.begin();
+            for (const auto row : stream)
+            {
+                REQUIRE(expected != parser.end());
+                REQUIRE(expected->raw() == row.raw());
+                auto expected_cell = expected->begin();
+                for (const auto cell : row)
+                    REQUIRE((expected_cell++)->raw() == cell.raw());
+                ++expected;
+            }
+            REQUIRE(expected == parser.end());
+        }
+    }
+}
+
+TEST_CASE("Stream parser", "[stream_parser]")
+{
+    check_stream<lazycsv::multiline_cells<false>>("\nA0,B0,C0,D0\nA1,B1,C1,D1\n\n\nA2,\"B,2\"\n\nA3,B3,C3,D3\n\n");
+    check_stream<lazycsv::multiline_cells<false>>("A0\nA1\nA2 has a longer row than the others\nA3");
+    check_stream<lazycsv::multiline_cells<true>>("A0,\"B\n0\",C0\n\"A1\"\"\n\",B1,C1\nA2,B2,\"C\n\n2\"\n");
+    check_stream<lazycsv::multiline_cells<true>>("A0,\"B\n0\"\nA1,\"B1\n");
+
+    lazycsv::stream_parser<> stream{ lazycsv::fd_reader{ "inputs/basic.csv" } };
+    REQUIRE(2 == stream.index_of("C0"));
+    std::vector<std::string> rows;
+    for (const auto row : stream)
+        rows.emplace_back(row.raw());
+    REQUIRE(std::vector<std::string>{ "A1,B1,C1,D1", "A2,B2,C2,D2", "A3,B3,C3,D3" } == rows);
+}
+
+TEST_CASE("MmapSource options", "[mmap_source]")
+{
+    for (const auto access : { lazycsv::access_pattern::normal,
+                               lazycsv::access_pattern::sequential,
+                               lazycsv::access_pattern::random,
+                               lazycsv::access_pattern::will_need })
+    {
+        lazycsv::mmap_options options;
+        options.access = access;
+        options.populate = true;
+        options.huge_pages = true;
+        lazycsv::parser parser{ "inputs/basic.csv", options };
+        check_rows(parser, { { "A1", "B1", "C1", "D1" }, { "A2", "B2", "C2", "D2" }, { "A3", "B3", "C3", "D3" } });
+    }
+}
+
+TEST_CASE("MmapSource read ahead", "[mmap_source]")
+{
+    {
+        std::ofstream file{ "read_ahead.csv" };
+        file << "A,B\n";
+        for (auto i = 0; i < 10000; i++)
+            file << "A" << i << ",B" << i << "\n";
+    }
+
+    lazycsv::mmap_options options;
+    options.read_ahead = 16 * 1024;
+    lazycsv::parser parser{ "read_ahead.csv", options };
+    const auto& source = parser.data_source();
+
+    const auto wait_for_prefetched = [&](std::size_t offset)
+    {
+        for (auto i = 0; i < 500 && source.prefetched() < offset; i++)
+            std::this_thread::sleep_for(std::chrono::milliseconds{ 10 });
+        return source.prefetched();
+    };
+    REQUIRE(wait_for_prefetched(options.read_ahead) >= options.read_ahead);
+
+    std::size_t rows = 0;
+    for (const auto row : parser)
+    {
+        source.consumed(row.raw().data());
+        rows++;
+    }
+    REQUIRE(10000 == rows);
+    REQUIRE(source.size() == wait_for_prefetched(source.size()));
+    std::remove("read_ahead.csv");
+}
+
+TEST_CASE("Parser numeric cells", "[cell]")
+{
+    lazycsv::parser<std::string, lazycsv::has_header<false>> parser{ "42, -7 ,3.25,1e3\n12a,,99999999999,x\n" };
+    auto rows = parser.begin();
+    const auto [a0, b0, c0, d0] = rows->cells(0, 1, 2, 3);
+    REQUIRE(42 == a0.as<int>().value);
+    REQUIRE(-7 == b0.as<long>().value);
+    REQUIRE(3.25 == c0.as<double>().value);
+    REQUIRE(1000.0f == d0.as<float>().value);
+    REQUIRE(a0.as<unsigned>());
+    REQUIRE(std::errc::invalid_argument == b0.as<unsigned>().error);
+
+    const auto [a1, b1, c1, d1] = (++rows)->cells(0, 1, 2, 3);
+    REQUIRE(std::errc::invalid_argument == a1.as<int>().error);
+    REQUIRE(std::errc::invalid_argument == b1.as<double>().error);
+    REQUIRE(std::errc::result_out_of_range == c1.as<int>().error);
+    REQUIRE(99999999999 == c1.as<std::int64_t>().value);
+    REQUIRE_FALSE(d1.as<double>());
+}
+
+TEST_CASE("Parser unescape_into", "[cell]")
+{
+    lazycsv::parser<std::string, lazycsv::has_header<false>> parser{ "\"A0\"\"\",B0\n\"D\"\"2\",\n" };
+    std::string buffer;
+    std::vector<std::string> cells;
+    for (const auto row : parser)
+        for (const auto cell : row)
+            cells.emplace_back(cell.unescape_into(buffer));
+    REQUIRE(std::vector<std::string>{ "A0\"", "B0", "D\"2", "" } == cells);
+}
+
+struct city
+{
+    std::string_view name;
+    std::string state;
+    std::uint32_t population;
+    double area;
+};
+
+TEST_CASE("Parser bind", "[binding]")
+{
+    lazycsv::parser<std::string> parser{ "name,area,\"state\",population,code\nQuahog, 12.5 ,\"Rhode \"\"Island\"\"\",30000,RI\nx,y\n" };
+    const auto binding = parser.bind(lazycsv::column{ "population", &city::population },
+                                     lazycsv::column{ "name", &city::name },
+                                     lazycsv::column{ "state", &city::state },
+                                     lazycsv::column{ "area", &city::area });
+
+    auto rows = parser.begin();
+    const auto quahog = binding.decode(*rows);
+    REQUIRE(quahog.name == "Quahog");
+    REQUIRE(quahog.state == "Rhode \"Island\"");
+    REQUIRE(quahog.population == 30000);
+    REQUIRE(quahog.area == 12.5);
+    REQUIRE_THROWS_AS(binding.decode(*++rows), lazycsv::error);
+    REQUIRE_THROWS_AS(parser.bind(lazycsv::column{ "country", &city::name }), lazycsv::error);
+
+    lazycsv::stream_parser<> stream{ lazycsv::fd_reader{ "inputs/basic.csv" } };
+    const auto stream_binding = stream.bind(lazycsv::column{ "C0", &city::name }, lazycsv::column{ "A0", &city::state });
+    std::vector<std::string> cells;
+    for (const auto row : stream)
+    {
+        const auto decoded = stream_binding.decode(row);
+        cells.push_back(decoded.state + std::string{ decoded.name });
+    }
+    REQUIRE(cells == std::vector<std::string>{ "A1C1", "A2C2", "A3C3" });
+}
+
+TEST_CASE("Parser project", "[projection]")
+{
+    std::string csv = "id,name,price\n";
+    for (auto i = 0; i < 50; i++)
+        csv += std::to_string(i) + ",\"" + std::string(i, 'n') + ",\"\"" + std::to_string(i) + "\"\"\"," + std::to_string(i * 0.5) + "\n";
+    lazycsv::parser<std::string> parser{ csv };
+
+    const auto projection = parser.project<double, std::string, std::uint32_t, std::string_view>("price", "name", "id", "price");
+    REQUIRE(50 == projection.size());
+    for (std::size_t i = 0; i < projection.size(); i++)
+    {
+        REQUIRE(i * 0.5 == projection.column<0>()[i]);
+        REQUIRE(std::string(i, 'n') + ",\"" + std::to_string(i) + "\"" == projection.column<1>()[i]);
+        REQUIRE(i == projection.column<2>()[i]);
+        REQUIRE(std::to_string(i * 0.5) == projection.column<3>()[i]);
+    }
+    REQUIRE(projection.column<1>().offsets().back() == projection.column<1>().data().size());
+
+    decltype(parser)::projection<int, std::string> short_rows{ { 0, 2 } };
+    short_rows.append(*parser.begin());
+    REQUIRE_THROWS_AS(short_rows.append(decltype(parser)::row{ csv.data(), csv.data() + 3 }), lazycsv::error);
+    const std::string invalid_number = "x,y,z";
+    const decltype(parser)::row invalid_row{ invalid_number.data(), invalid_number.data() + invalid_number.size() };
+    REQUIRE_THROWS_AS(short_rows.append(invalid_row), lazycsv::error);
+    REQUIRE(1 == short_rows.size());
+    REQUIRE(1 == short_rows.column<0>().size());
+    REQUIRE(1 == short_rows.column<1>().size());
+
+    lazycsv::stream_parser<> stream{ lazycsv::fd_reader{ "inputs/basic.csv" } };
+    const auto stream_projection = stream.project<std::string>("B0");
+    REQUIRE(3 == stream_projection.size());
+    REQUIRE("B1B2B3" == stream_projection.column<0>().data());
+}
+
+TEST_CASE("Sniff dialect", "[dialect]")
+{
+    const auto check = [](std::string_view sample, char delimiter, char quote, bool header, bool multiline)
+    {
+        const auto dialect = lazycsv::sniff(sample);
+        REQUIRE(delimiter == dialect.delimiter);
+        REQUIRE(quote == dialect.quote_char);
+        REQUIRE(header == dialect.has_header);
+        REQUIRE(multiline == dialect.multiline_cells);
+    };
+    check("name,age\nPeter,45\nLois,43\n", ',', '"', true, false);
+    check("name;price\n\"a;b\";1,5\nc;2,25\nd;3", ';', '"', true, false);
+    check("name\tnote\n'a\tb'\tc\n", '\t', '\'', true, false);
+    check("1|2|3\n4|5|6\n7|8", '|', '"', false, false);
+    check("name,note\nPeter,\"multi\nline\"\n", ',', '"', true, true);
+    check("", ',', '"', true, false);
+}
+
+TEST_CASE("Dialect parser", "[dialect]")
+{
+    {
+        std::ofstream file{ "dialect.csv" };
+        file << "name;city\n\"Peter;Griffin\";Quahog\nLois;Quahog\n";
+    }
+
+    lazycsv::dialect_parser parser{ "dialect.csv" };
+    REQUIRE(';' == parser.dialect().delimiter);
+    const auto names = parser.visit(
+        [](const auto& specialized)
+        {
+            std::vector<std::string> result;
+            const auto name_index = specialized.index_of("name");
+            for (const auto row : specialized)
+            {
+                const auto [name] = row.cells(name_index);
+                result.push_back(name.unescaped());
+            }
+            return result;
+        });
+    REQUIRE(names == std::vector<std::string>{ "Peter;Griffin", "Lois" });
+
+    parser.set_dialect({ ':', '"', true, false });
+    REQUIRE_THROWS_AS(parser.visit([](const auto&) {}), lazycsv::error);
+    std::remove("dialect.csv");
+}
+
+TEST_CASE("Parser unescaped views", "[cell]")
+{
+    lazycsv::parser<std::string, lazycsv::has_header<false>> parser{ "A0,\"B,0\",\"C\"\"0\"\n" };
+    const auto [a0, b0, c0] = parser.begin()->cells(0, 1, 2);
+    const auto a0_unescaped = a0.unescaped();
+    const auto b0_unescaped = b0.unescaped();
+    const auto c0_unescaped = c0.unescaped();
+    REQUIRE(a0_unescaped == "A0");
+    REQUIRE(b0_unescaped == "B,0");
+    REQUIRE(c0_unescaped == "C\"0");
+    REQUIRE_FALSE(a0_unescaped.copied());
+    REQUIRE_FALSE(b0_unescaped.copied());
+    REQUIRE(c0_unescaped.copied());
+    REQUIRE(b0.trimed().data() == b0_unescaped.view().data());
+
+    std::string buffer;
+    REQUIRE(a0.trimed().data() == a0.unescape_into(buffer).data());
+    REQUIRE(buffer.data() == c0.unescape_into(buffer).data());
+}
+
+#if __has_include(<cista/serialization.h>)
+struct cista_city
+{
+    cista::offset::string name;
+    std::uint32_t population;
+};
+
+TEST_CASE("Parser to cista snapshot", "[cista]")
+{
+    std::string csv = "name,population\n";
+    for (auto i = 0; i < 1000; i++)
+        csv += "\"city " + std::to_string(i) + (i % 7 ? "" : " \"\"old\"\"") + "\"," + std::to_string(i) + "\n";
+    lazycsv::parser<std::string> parser{ csv };
+    const auto binding =
+        parser.bind(lazycsv::column{ "name", &cista_city::name }, lazycsv::column{ "population", &cista_city::population });
+
+    lazycsv::save_snapshot("cities.bin", lazycsv::to_cista(parser, binding, 4));
+    {
+        const lazycsv::snapshot<cista_city> loaded{ "cities.bin" };
+        REQUIRE(loaded.rows().size() == 1000);
+        for (std::uint32_t i = 0; i < 1000; i++)
+        {
+            REQUIRE(loaded.rows()[i].name.view() == "city " + std::to_string(i) + (i % 7 ? "" : " \"old\""));
+            REQUIRE(loaded.rows()[i].population == i);
+        }
+    }
+    std::remove("cities.bin");
+
+    lazycsv::parser<std::string> invalid{ csv + "x,y\n" };
+    const auto population = invalid.bind(lazycsv::column{ "population", &cista_city::population });
+    REQUIRE_THROWS_AS(lazycsv::to_cista(invalid, population, 4), lazycsv::error);
+}
+
+TEST_CASE("Group by", "[cista]")
+{
+    std::string csv = "region,name,amount\n";
+    for (auto i = 0; i < 10000; i++)
+        csv += (i % 3 ? "r" + std::to_string(i % 5) : "\"r\"\"" + std::to_string(i % 5) + "\"") + ",x," + std::to_string(i) + "\n";
+    lazycsv::parser<std::string> parser{ csv };
+    const auto result = lazycsv::group_by<std::int64_t>(parser, "region", "amount", 4);
+
+    std::map<std::string, std::pair<std::int64_t, std::size_t>> expected;
+    for (auto i = 0; i < 10000; i++)
+    {
+        auto& group = expected[(i % 3 ? "r" : "r\"") + std::to_string(i % 5)];
+        group.first += i;
+        group.second++;
+    }
+    REQUIRE(result.groups.size() == expected.size());
+    for (const auto& [key, group] : expected)
+    {
+        const auto found = result.groups.find(std::string_view{ key });
+        REQUIRE(found != result.groups.end());
+        REQUIRE(found->second.sum == group.first);
+        REQUIRE(found->second.count == group.second);
+    }
+
+    REQUIRE_THROWS_AS(lazycsv::group_by(parser, "amount", "amount"), lazycsv::error);
+    REQUIRE_THROWS_AS(lazycsv::group_by(parser, "amount", "name"), lazycsv::error);
+}
+#endif
+
+TEST_CASE("Parser validate", "[validate]")
+{
+    lazycsv::parser<std::string> parser{ "A,B,C\nA1,B1,C1\nA2,B2\nA3,\"B,3\",C3\nA4,B4,C4,D4\nA5,\"B5,C5\n" };
+    auto rows = parser.validate();
+    std::vector<std::size_t> cell_counts;
+    std::vector<bool> malformed;
+    for (const auto& row : rows)
+    {
+        cell_counts.push_back(row.cell_count);
+        malformed.push_back(row.malformed);
+        if (!row.malformed)
+            REQUIRE(row.content.cells(0, 1, 2).size() == 3);
+    }
+    REQUIRE(cell_counts == std::vector<std::size_t>{ 3, 2, 3, 4, 2 });
+    REQUIRE(malformed == std::vector<bool>{ false, true, false, true, true });
+    REQUIRE(rows.stats().rows == 5);
+    REQUIRE(rows.stats().bad_rows == 3);
+    REQUIRE(rows.stats().max_cells == 4);
+
+    REQUIRE(parser.validate(4).begin()->malformed);
+    REQUIRE(std::next(parser.begin())->try_cells(0, 1));
+    REQUIRE_FALSE(std::next(parser.begin())->try_cells(0, 2));
+}
+
+TEST_CASE("Follow parser", "[follow_parser]")
+{
+    std::remove("follow.csv");
+    std::ofstream file{ "follow.csv" };
+    lazycsv::follow_parser<> parser{ "follow.csv" };
+    const auto next_rows = [&]
+    {
+        std::vector<std::string> rows;
+        for (const auto row : parser.next_rows())
+            rows.emplace_back(row.raw());
+        return rows;
+    };
+    REQUIRE(next_rows().empty());
+
+    file << "A,B\nA1,B1\nA2," << std::flush;
+    REQUIRE(next_rows() == std::vector<std::string>{ "A1,B1" });
+    REQUIRE(parser.index_of("B") == 1);
+
+    std::thread writer{ [&]
+                        {
+                            std::this_thread::sleep_for(std::chrono::milliseconds{ 20 });
+                            file << "B2\nA3,B3\n" << std::flush;
+                        } };
+    REQUIRE(parser.wait(std::chrono::seconds{ 10 }));
+    writer.join();
+    REQUIRE(next_rows() == std::vector<std::string>{ "A2,B2", "A3,B3" });
+    REQUIRE_FALSE(parser.wait(std::chrono::milliseconds{ 1 }));
+
+    for (auto i = 0; i < 100000; i++)
+        file << "A" << i << ",B" << i << "\n";
+    file.flush();
+    const auto rows = next_rows();
+    REQUIRE(rows.size() == 100000);
+    REQUIRE(rows.back() == "A99999,B99999");
+
+    lazycsv::follow_parser<> resumed{ "follow.csv", parser.offset() - 7 };
+    file << "A,B\n" << std::flush;
+    std::vector<std::string> resumed_rows;
+    for (const auto row : resumed.next_rows())
+        resumed_rows.emplace_back(row.raw());
+    REQUIRE(resumed_rows == std::vector<std::string>{ "B99999", "A,B" });
+
+    // the offset of a file which was rotated or truncated since is clamped to its end
+    std::remove("follow_rotated.csv");
+    std::ofstream rotated_file{ "follow_rotated.csv" };
+    lazycsv::follow_parser<> rotated{ "follow_rotated.csv", parser.offset() };
+    std::vector<std::string> rotated_rows;
+    for (const auto row : rotated.next_rows())
+        rotated_rows.emplace_back(row.raw());
+    rotated_file << "A,B\nA1,B1\n" << std::flush;
+    for (const auto row : rotated.next_rows())
+        rotated_rows.emplace_back(row.raw());
+    REQUIRE(rotated_rows == std::vector<std::string>{ "A1,B1" });
+    std::remove("follow_rotated.csv");
+    std::remove("follow.csv");
+}
+
+TEST_CASE("Follow parser with multiline cells", "[follow_parser]")
+{
+    std::remove("follow_multiline.csv");
+    std::ofstream file{ "follow_multiline.csv" };
+    lazycsv::follow_parser<lazycsv::has_header<false>,
+                           lazycsv::delimiter<','>,
+                           lazycsv::quote_char<'"'>,
+                           lazycsv::trim_chars<' ', '\t'>,
+                           lazycsv::multiline_cells<true>>
+        parser{ "follow_multiline.csv" };
+
+    file << "A0,\"B\n0\"\nA1,\"B\n" << std::flush;
+    std::vector<std::string> rows;
+    for (const auto row : parser.next_rows())
+        rows.emplace_back(row.raw());
+    file << "1\"\n" << std::flush;
+    for (const auto row : parser.next_rows())
+        rows.emplace_back(row.raw());
+    REQUIRE(rows == std::vector<std::string>{ "A0,\"B\n0\"", "A1,\"B\n1\"" });
+    std::remove("follow_multiline.csv");
+}
+
+TEST_CASE("Writer", "[writer]")
+{
+    std::string output;
+    auto sink = [&output](const char* data, std::size_t size) { output.append(data, size); };
+    const auto long_field = std::string(70, 'x') + "\"quoted\"";
+    {
+        lazycsv::writer<decltype(sink)> writer{ sink, 8 };
+        writer.write_row("name", "value", "score");
+        writer.write_row("a,b", -42, 0.5);
+        writer.write_row(std::string{ "line\nbreak" }, std::string_view{}, 18446744073709551615ull);
+        writer.write_cell(long_field);
+        writer.write_cell(1.5f);
+        writer.write_cell('c');
+        writer.write_cell(',');
+        writer.end_row();
+    }
+    const auto expected = "name,value,score\n\"a,b\",-42,0.5\n\"line\nbreak\",,18446744073709551615\n\"" + std::string(70, 'x') +
+                          "\"\"quoted\"\"\",1.5,c,\",\"\n";
+    REQUIRE(output == expected);
+
+    lazycsv::parser<std::string,
+                    lazycsv::has_header<true>,
+                    lazycsv::delimiter<','>,
+                    lazycsv::quote_char<'"'>,
+                    lazycsv::trim_chars<>,
+                    lazycsv::multiline_cells<true>>
+        parser{ output };
+    std::vector<std::string> cells;
+    for (const auto row : parser)
+    {
+        for (const auto cell : row)
+            cells.emplace_back(cell.unescaped());
+    }
+    REQUIRE(cells ==
+            std::vector<std::string>{ "a,b", "-42", "0.5", "line\nbreak", "", "18446744073709551615", long_field, "1.5", "c", "," });
+}
+
+TEST_CASE("Writer to file", "[writer]")
+{
+    lazycsv::writer<> writer{ lazycsv::fd_writer{ "written.csv" } };
+    for (auto i = 0; i < 100000; i++)
+        writer.write_row("A", i, "B;\"");
+    writer.close();
+
+    lazycsv::writer<> failing_writer{ lazycsv::fd_writer{ -1 } };
+    failing_writer.write_row("A");
+    REQUIRE_THROWS(failing_writer.close());
+
+    lazycsv::parser<lazycsv::mmap_source, lazycsv::has_header<false>> parser{ "written.csv" };
+    std::size_t rows = 0;
+    std::string last_row;
+    for (const auto row : parser)
+    {
+        rows++;
+        last_row = row.raw();
+    }
+    REQUIRE(rows == 100000);
+    REQUIRE(last_row == "A,99999,\"B;\"\"\"");
+    std::remove("written.csv");
+}
+
+TEST_CASE("Multi parser", "[multi_parser]")
+{
+    const std::vector<std::string> paths{ "part0.csv", "part1.csv", "part2.csv" };
+    std::vector<std::string> expected;
+    for (std::size_t file = 0; file < paths.size(); file++)
+    {
+        std::ofstream output{ paths[file] };
+        output << "id,name\n";
+        for (auto i = 0; i < (file == 1 ? 0 : 1000 * static_cast<int>(file + 1)); i++)
+        {
+            expected.push_back(std::to_string(file) + "-" + std::to_string(i) + ",\"n," + std::to_string(i) + "\"");
+            output << expected.back() << (i == 2999 ? "" : "\n");
+        }
+    }
+
+    lazycsv::multi_parser<> parser{ paths, 4096 };
+    REQUIRE(parser.index_of("name") == 1);
+    std::vector<std::string> rows;
+    for (const auto row : parser)
+        rows.emplace_back(row.raw());
+    REQUIRE(rows == expected);
+
+    const auto units = parser.work_units();
+    REQUIRE(units.size() > paths.size());
+    std::vector<std::vector<std::string>> unit_rows(units.size());
+    std::vector<std::thread> workers;
+    for (std::size_t i = 0; i < units.size(); i++)
+    {
+        workers.emplace_back(
+            [&, i]
+            {
+                for (const auto row : parser.rows(units[i]))
+                    unit_rows[i].emplace_back(row.raw());
+            });
+    }
+    for (auto& worker : workers)
+        worker.join();
+    rows.clear();
+    for (const auto& part : unit_rows)
+        rows.insert(rows.end(), part.begin(), part.end());
+    std::sort(rows.begin(), rows.end());
+    std::sort(expected.begin(), expected.end());
+    REQUIRE(rows == expected);
+
+    std::ofstream{ "part1.csv" } << "id,title\n1,a\n";
+    lazycsv::multi_parser<> mismatched{ paths };
+    REQUIRE_THROWS_AS(mismatched.file(1), lazycsv::error);
+    REQUIRE_THROWS_AS(lazycsv::multi_parser<>{ std::vector<std::string>{ "part3.csv" } }, lazycsv::error);
+    for (const auto& path : paths)
+        std::remove(path.c_str());
+}
+
+TEST_CASE("Compact rows and cells", "[compact]")
+{
+    static_assert(sizeof(lazycsv::compact_range<>) == 8);
+    lazycsv::parser<std::string> parser{ "key,value\nb,\"\"\"x\"\"\"\na, \"y\" \nc,\"\"\n" };
+    std::vector<lazycsv::compact_range<>> cells;
+    lazycsv::compact_rows<decltype(parser)> rows{ parser };
+    for (const auto row : parser)
+    {
+        rows.push_back(row);
+        for (const auto cell : row)
+            cells.push_back(parser.compact(cell));
+    }
+
+    std::vector<std::string> unescaped;
+    for (const auto& handle : cells)
+        unescaped.emplace_back(parser.expand_cell(handle).unescaped());
+    REQUIRE(unescaped == std::vector<std::string>{ "b", "\"x\"", "a", "\"y\"", "c", "" });
+    REQUIRE(parser.expand_cell(cells[1]).raw() == "\"\"x\"\"");
+
+    auto& handles = rows.handles();
+    std::sort(handles.begin(),
+              handles.end(),
+              [&](const auto& lhs, const auto& rhs) { return parser.expand_row(lhs).raw() < parser.expand_row(rhs).raw(); });
+    REQUIRE(rows.size() == 3);
+    REQUIRE(rows[0].raw() == "a, \"y\" ");
+    REQUIRE(rows[1].raw() == "b,\"\"\"x\"\"\"");
+    REQUIRE(rows[2].raw() == "c,\"\"");
+
+    const auto wide = parser.compact<48>(*parser.begin());
+    REQUIRE(wide.offset() == 10);
+    REQUIRE(wide.size() == 9);
+    REQUIRE_THROWS_AS(lazycsv::compact_range<48>(0, 1 << 16), lazycsv::error);
+    REQUIRE_THROWS_AS(lazycsv::compact_range<32>(std::size_t{ 1 } << 32, 0), lazycsv::error);
+}
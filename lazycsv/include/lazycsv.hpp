@@ -2,22 +2,417 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <cctype>
 #include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <fstream>
 #include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <ostream>
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <system_error>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include <fcntl.h>
+#include <poll.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+#if defined(__SSE2__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define LAZYCSV_SIMD_X86
+#endif
+
 namespace lazycsv
 {
 namespace detail
 {
+namespace simd
+{
+constexpr std::size_t block_size = 64;
+constexpr std::ptrdiff_t probe_size = 8;
+
+struct block
+{
+    std::uint64_t quote;
+    std::uint64_t structural;
+};
+
+// turns a bitmask of quote characters into a mask of quoted regions (bit i = parity of quotes in [0, i])
+inline auto prefix_xor(std::uint64_t bits)
+{
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+#ifdef LAZYCSV_SIMD_X86
+struct sse2
+{
+    static auto classify(const char* data, char quote, char structural)
+    {
+        const auto quotes = _mm_set1_epi8(quote);
+        const auto structurals = _mm_set1_epi8(structural);
+        block result{ 0, 0 };
+        for (std::size_t i = 0; i < block_size; i += 16)
+        {
+            const auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            result.quote |= std::uint64_t{ static_cast<std::uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, quotes))) } << i;
+            result.structural |= std::uint64_t{ static_cast<std::uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, structurals))) } << i;
+        }
+        return result;
+    }
+};
+
+struct avx2
+{
+    [[gnu::target("avx2")]] static auto classify(const char* data, char quote, char structural)
+    {
+        const auto lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+        const auto hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + 32));
+        return block{ mask(lo, hi, quote), mask(lo, hi, structural) };
+    }
+
+  private:
+    [[gnu::target("avx2")]] static std::uint64_t mask(__m256i lo, __m256i hi, char character)
+    {
+        const auto pattern = _mm256_set1_epi8(character);
+        const auto lo_mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, pattern)));
+        const auto hi_mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, pattern)));
+        return std::uint64_t{ lo_mask } | std::uint64_t{ hi_mask } << 32;
+    }
+};
+#endif
+
+// finds the first structural character which is not enclosed in quotes, if there is none `inside` holds the quote state at `end`
+inline const char* find_unquoted_scalar(const char* begin, const char* end, char quote, char structural, std::uint64_t& inside)
+{
+    for (const auto* i = begin; i < end; i++)
+    {
+        if (*i == quote)
+            inside = ~inside;
+        else if (*i == structural && !inside)
+            return i;
+    }
+    return end;
+}
+
+template<class isa>
+const char* find_unquoted(const char* begin, const char* end, char quote, char structural, std::uint64_t& inside)
+{
+    // short cells are resolved faster byte by byte than by classifying a whole block
+    const auto* i = begin + std::min(end - begin, probe_size);
+    if (const auto* found = find_unquoted_scalar(begin, i, quote, structural, inside); found != i)
+        return found;
+
+    for (; end - i >= static_cast<std::ptrdiff_t>(block_size); i += block_size)
+    {
+        const auto [quotes, structurals] = isa::classify(i, quote, structural);
+        if (!(quotes | inside)) // fast path for blocks without quotes
+        {
+            if (structurals)
+                return i + __builtin_ctzll(structurals);
+            continue;
+        }
+        const auto quoted = prefix_xor(quotes) ^ inside;
+        if (const auto hits = structurals & ~quoted)
+            return i + __builtin_ctzll(hits);
+        inside = static_cast<std::uint64_t>(static_cast<std::int64_t>(quoted) >> 63);
+    }
+
+    return find_unquoted_scalar(i, end, quote, structural, inside);
+}
+
+// returns all ones if [begin, end) contains an odd number of quotes, this is the quote state at `end` when `begin` is unquoted
+inline std::uint64_t quote_parity_scalar(const char* begin, const char* end, char quote)
+{
+    std::uint64_t parity = 0;
+    for (const auto* i = begin; i < end; i++)
+        parity ^= (*i == quote);
+    return std::uint64_t{ 0 } - parity;
+}
+
+template<class isa>
+std::uint64_t quote_parity(const char* begin, const char* end, char quote)
+{
+    std::uint64_t quotes = 0;
+    const auto* i = begin;
+    for (; end - i >= static_cast<std::ptrdiff_t>(block_size); i += block_size)
+        quotes ^= isa::classify(i, quote, quote).quote;
+    return (std::uint64_t{ 0 } - (__builtin_popcountll(quotes) & 1)) ^ quote_parity_scalar(i, end, quote);
+}
+
+// bitmask of structural characters in a block which are not enclosed in quotes, `inside` carries the quote state to the next block
+inline std::uint64_t unquoted_scalar(const char* block, char quote, char structural, std::uint64_t& inside)
+{
+    std::uint64_t structurals = 0;
+    for (std::size_t i = 0; i < block_size; i++)
+    {
+        if (block[i] == quote)
+            inside = ~inside;
+        else if (block[i] == structural && !inside)
+            structurals |= std::uint64_t{ 1 } << i;
+    }
+    return structurals;
+}
+
+template<class isa>
+std::uint64_t unquoted(const char* block, char quote, char structural, std::uint64_t& inside)
+{
+    const auto [quotes, structurals] = isa::classify(block, quote, structural);
+    if (!(quotes | inside))
+        return structurals;
+    const auto quoted = prefix_xor(quotes) ^ inside;
+    inside = static_cast<std::uint64_t>(static_cast<std::int64_t>(quoted) >> 63);
+    return structurals & ~quoted;
+}
+
+// true if [begin, end) has a quote, delimiter or new line character, such fields are quoted by the writer
+inline bool needs_quoting_scalar(const char* begin, const char* end, char quote, char delimiter)
+{
+    for (const auto* i = begin; i < end; i++)
+    {
+        if (*i == quote || *i == delimiter || *i == '\n' || *i == '\r')
+            return true;
+    }
+    return false;
+}
+
+template<class isa>
+bool needs_quoting(const char* begin, const char* end, char quote, char delimiter)
+{
+    const auto* i = begin;
+    for (; end - i >= static_cast<std::ptrdiff_t>(block_size); i += block_size)
+    {
+        const auto [quotes, delimiters] = isa::classify(i, quote, delimiter);
+        const auto [new_lines, carriage_returns] = isa::classify(i, '\n', '\r');
+        if (quotes | delimiters | new_lines | carriage_returns)
+            return true;
+    }
+    return needs_quoting_scalar(i, end, quote, delimiter);
+}
+
+#ifdef LAZYCSV_SIMD_X86
+inline bool avx2_supported()
+{
+    static const bool supported = []
+    {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") != 0;
+    }();
+    return supported;
+}
+
+[[gnu::target("avx2"), gnu::flatten]] inline const char* find_unquoted_avx2(
+    const char* begin, const char* end, char quote, char structural, std::uint64_t& inside)
+{
+    return find_unquoted<avx2>(begin, end, quote, structural, inside);
+}
+
+[[gnu::flatten]] inline const char* find_unquoted_sse2(const char* begin, const char* end, char quote, char structural, std::uint64_t& inside)
+{
+    return find_unquoted<sse2>(begin, end, quote, structural, inside);
+}
+
+[[gnu::target("avx2"), gnu::flatten]] inline std::uint64_t quote_parity_avx2(const char* begin, const char* end, char quote)
+{
+    return quote_parity<avx2>(begin, end, quote);
+}
+
+[[gnu::flatten]] inline std::uint64_t quote_parity_sse2(const char* begin, const char* end, char quote)
+{
+    return quote_parity<sse2>(begin, end, quote);
+}
+
+[[gnu::target("avx2"), gnu::flatten]] inline std::uint64_t unquoted_avx2(const char* block, char quote, char structural, std::uint64_t& inside)
+{
+    return unquoted<avx2>(block, quote, structural, inside);
+}
+
+[[gnu::flatten]] inline std::uint64_t unquoted_sse2(const char* block, char quote, char structural, std::uint64_t& inside)
+{
+    return unquoted<sse2>(block, quote, structural, inside);
+}
+
+[[gnu::target("avx2"), gnu::flatten]] inline bool needs_quoting_avx2(const char* begin, const char* end, char quote, char delimiter)
+{
+    return needs_quoting<avx2>(begin, end, quote, delimiter);
+}
+
+[[gnu::flatten]] inline bool needs_quoting_sse2(const char* begin, const char* end, char quote, char delimiter)
+{
+    return needs_quoting<sse2>(begin, end, quote, delimiter);
+}
+#endif
+
+inline const char* find_unquoted(const char* begin, const char* end, char quote, char structural, std::uint64_t& inside)
+{
+#ifdef LAZYCSV_SIMD_X86
+    if (avx2_supported())
+        return find_unquoted_avx2(begin, end, quote, structural, inside);
+    return find_unquoted_sse2(begin, end, quote, structural, inside);
+#else
+    return find_unquoted_scalar(begin, end, quote, structural, inside);
+#endif
+}
+
+inline std::uint64_t quote_parity(const char* begin, const char* end, char quote)
+{
+#ifdef LAZYCSV_SIMD_X86
+    if (avx2_supported())
+        return quote_parity_avx2(begin, end, quote);
+    return quote_parity_sse2(begin, end, quote);
+#else
+    return quote_parity_scalar(begin, end, quote);
+#endif
+}
+
+inline std::uint64_t unquoted(const char* block, char quote, char structural, std::uint64_t& inside)
+{
+#ifdef LAZYCSV_SIMD_X86
+    if (avx2_supported())
+        return unquoted_avx2(block, quote, structural, inside);
+    return unquoted_sse2(block, quote, structural, inside);
+#else
+    return unquoted_scalar(block, quote, structural, inside);
+#endif
+}
+
+inline bool needs_quoting(const char* begin, const char* end, char quote, char delimiter)
+{
+#ifdef LAZYCSV_SIMD_X86
+    if (avx2_supported())
+        return needs_quoting_avx2(begin, end, quote, delimiter);
+    return needs_quoting_sse2(begin, end, quote, delimiter);
+#else
+    return needs_quoting_scalar(begin, end, quote, delimiter);
+#endif
+}
+
+// appends the position of every structural character which is not enclosed in quotes to `positions`
+template<class container>
+void find_all_unquoted(const char* begin, const char* end, char quote, char structural, container& positions)
+{
+    std::uint64_t inside = 0;
+    const auto* block = begin;
+    for (; end - block >= static_cast<std::ptrdiff_t>(block_size); block += block_size)
+    {
+        for (auto hits = unquoted(block, quote, structural, inside); hits; hits &= hits - 1)
+            positions.push_back(block + __builtin_ctzll(hits));
+    }
+
+    if (const auto remaining = static_cast<std::size_t>(end - block))
+    {
+        char padded[block_size] = {};
+        std::memcpy(padded, block, remaining);
+        auto hits = unquoted(padded, quote, structural, inside) & ((std::uint64_t{ 1 } << remaining) - 1);
+        for (; hits; hits &= hits - 1)
+            positions.push_back(block + __builtin_ctzll(hits));
+    }
+}
+
+// number of structural characters which are not enclosed in quotes, `inside` is left with the quote state at `end`
+inline std::size_t count_unquoted(const char* begin, const char* end, char quote, char structural, std::uint64_t& inside)
+{
+    std::size_t count = 0;
+    const auto* block = begin;
+    for (; end - block >= static_cast<std::ptrdiff_t>(block_size); block += block_size)
+        count += __builtin_popcountll(unquoted(block, quote, structural, inside));
+
+    if (const auto remaining = static_cast<std::size_t>(end - block))
+    {
+        char padded[block_size] = {};
+        std::memcpy(padded, block, remaining);
+        count += __builtin_popcountll(unquoted(padded, quote, structural, inside) & ((std::uint64_t{ 1 } << remaining) - 1));
+    }
+    return count;
+}
+
+// calls `visit(ordinal, cell_begin, cell_end)` for the cells at the ascending `indexes` of the row [begin, end), cells in between
+// are skipped by counting the delimiters of whole blocks, returns the number of visited indexes
+template<class visitor>
+std::size_t for_each_cell_at(
+    const char* begin, const char* end, char quote, char delimiter, const int* indexes, std::size_t count, visitor&& visit)
+{
+    std::size_t next = 0;
+    int index = 0; // the index of the cell at cell_begin, or the count of skipped delimiters
+    const char* cell_begin = begin;
+    std::uint64_t inside = 0;
+
+    const auto consume = [&](const char* block, std::uint64_t delimiters)
+    {
+        while (delimiters && next < count)
+        {
+            if (index < indexes[next])
+            {
+                const auto needed = indexes[next] - index;
+                const auto available = __builtin_popcountll(delimiters);
+                if (available < needed)
+                {
+                    index += available;
+                    return;
+                }
+                for (auto i = 1; i < needed; i++)
+                    delimiters &= delimiters - 1;
+                cell_begin = block + __builtin_ctzll(delimiters) + 1;
+                delimiters &= delimiters - 1;
+                index = indexes[next];
+            }
+            else
+            {
+                const auto* const cell_end = block + __builtin_ctzll(delimiters);
+                delimiters &= delimiters - 1;
+                for (; next < count && indexes[next] == index; next++)
+                    visit(next, cell_begin, cell_end);
+                cell_begin = cell_end + 1;
+                index++;
+            }
+        }
+    };
+
+    const auto* block = begin;
+    for (; end - block >= static_cast<std::ptrdiff_t>(block_size) && next < count; block += block_size)
+        consume(block, unquoted(block, quote, delimiter, inside));
+
+    if (const auto remaining = static_cast<std::size_t>(end - block); remaining && next < count)
+    {
+        char padded[block_size] = {};
+        std::memcpy(padded, block, remaining);
+        consume(block, unquoted(padded, quote, delimiter, inside) & ((std::uint64_t{ 1 } << remaining) - 1));
+    }
+
+    for (; next < count && indexes[next] == index; next++) // the last cell ends with the row
+        visit(next, cell_begin, end);
+    return next;
+}
+} // namespace simd
+
 struct chunk_rows
 {
     static auto chunk(const char* begin, const char* dead_end)
@@ -28,6 +423,19 @@ struct chunk_rows
     }
 };
 
+template<char quote_char>
+struct chunk_quoted_rows
+{
+    static auto chunk(const char* begin, const char* dead_end)
+    {
+        std::uint64_t inside = 0;
+        const auto* end = simd::find_unquoted(begin, dead_end, quote_char, '\n', inside);
+        if (end == dead_end && inside && *(dead_end - 1) == '\n') // unclosed quote, the last new line still ends the row
+            return dead_end - 1;
+        return end;
+    }
+};
+
 template<char delimiter, char quote_char>
 struct chunk_cells
 {
@@ -67,6 +475,153 @@ struct chunk_cells
     }
 };
 
+template<char delimiter, char quote_char>
+struct simd_chunk_cells
+{
+    static auto chunk(const char* begin, const char* dead_end)
+    {
+        std::uint64_t inside = 0;
+        return simd::find_unquoted(begin, dead_end, quote_char, delimiter, inside);
+    }
+};
+
+// formats `value` into [begin, end) and returns the end of the output or nullptr if it doesn't fit, floating point values round trip
+template<class T>
+char* to_chars(char* begin, char* end, T value)
+{
+#if defined(__cpp_lib_to_chars)
+    constexpr auto native = true;
+#else
+    constexpr auto native = std::is_integral_v<T>;
+#endif
+    if constexpr (native)
+    {
+        const auto [formatted_end, error] = std::to_chars(begin, end, value);
+        return error == std::errc{} ? formatted_end : nullptr;
+    }
+    else
+    {
+        constexpr auto digits = std::numeric_limits<T>::max_digits10;
+        const auto size = static_cast<std::size_t>(end - begin);
+        int written = 0;
+        if constexpr (std::is_same_v<T, long double>)
+            written = std::snprintf(begin, size, "%.*Lg", digits, value);
+        else
+            written = std::snprintf(begin, size, "%.*g", digits, static_cast<double>(value));
+        if (written < 0 || static_cast<std::size_t>(written) >= size)
+            return nullptr;
+        return begin + written;
+    }
+}
+
+// parses the whole [begin, end) range into `value` without allocation
+template<class T>
+std::errc from_chars(const char* begin, const char* end, T& value)
+{
+#if defined(__cpp_lib_to_chars)
+    constexpr auto native = true;
+#else
+    constexpr auto native = std::is_integral_v<T>;
+#endif
+    if constexpr (native)
+    {
+        const auto [parsed_end, error] = std::from_chars(begin, end, value);
+        if (error != std::errc{})
+            return error;
+        return parsed_end == end ? std::errc{} : std::errc::invalid_argument;
+    }
+    else
+    {
+        // toolchains without floating point from_chars, strtod needs a null terminated copy
+        const auto size = static_cast<std::size_t>(end - begin);
+        char local_buffer[64];
+        std::string heap_buffer;
+        char* buffer = local_buffer;
+        if (size >= sizeof(local_buffer))
+        {
+            heap_buffer.assign(begin, end);
+            buffer = heap_buffer.data();
+        }
+        else
+        {
+            std::memcpy(local_buffer, begin, size);
+            local_buffer[size] = '\0';
+        }
+
+        if (size == 0 || std::isspace(static_cast<unsigned char>(*buffer)))
+            return std::errc::invalid_argument;
+        char* parsed_end = nullptr;
+        errno = 0;
+        if constexpr (std::is_same_v<T, float>)
+            value = std::strtof(buffer, &parsed_end);
+        else if constexpr (std::is_same_v<T, double>)
+            value = std::strtod(buffer, &parsed_end);
+        else
+            value = std::strtold(buffer, &parsed_end);
+        if (parsed_end != buffer + size)
+            return std::errc::invalid_argument;
+        return errno == ERANGE ? std::errc::result_out_of_range : std::errc{};
+    }
+}
+
+// keeps up to `capacity` elements inline and spills to the heap, the heap buffer is reused after clear()
+template<class T, std::size_t capacity>
+class small_vector
+{
+    std::array<T, capacity> inline_{};
+    std::vector<T> heap_;
+    std::size_t size_{ 0 };
+
+  public:
+    void push_back(const T& value)
+    {
+        if (size_ < capacity)
+        {
+            inline_[size_] = value;
+        }
+        else
+        {
+            if (size_ == capacity)
+                heap_.assign(inline_.begin(), inline_.end());
+            heap_.push_back(value);
+        }
+        size_++;
+    }
+
+    void clear()
+    {
+        heap_.clear();
+        size_ = 0;
+    }
+
+    auto size() const
+    {
+        return size_;
+    }
+
+    const auto& operator[](std::size_t index) const
+    {
+        return size_ <= capacity ? inline_[index] : heap_[index];
+    }
+};
+
+template<class iterator>
+struct iterator_range
+{
+    iterator first;
+    iterator last;
+
+    auto begin() const
+    {
+        return first;
+    }
+
+    auto end() const
+    {
+        return last;
+    }
+};
+
 template<class T, class chunk_policy>
 class fw_iterator
 {
@@ -130,6 +685,83 @@ struct error : std::runtime_error
     using std::runtime_error::runtime_error;
 };
 
+template<class T>
+struct conversion_result
+{
+    T value{};
+    std::errc error{};
+
+    explicit operator bool() const
+    {
+        return error == std::errc{};
+    }
+};
+
+// the unescaped text of a cell, it refers to the source unless the cell had escaped quotes
+class unescaped_string
+{
+    std::string_view view_;
+    std::string copy_;
+    bool copied_{ false };
+
+  public:
+    explicit unescaped_string(std::string_view view)
+        : view_(view)
+    {
+    }
+
+    explicit unescaped_string(std::string copy)
+        : copy_(std::move(copy))
+        , copied_(true)
+    {
+    }
+
+    auto view() const
+    {
+        return copied_ ? std::string_view(copy_) : view_;
+    }
+
+    bool copied() const
+    {
+        return copied_;
+    }
+
+    operator std::string_view() const
+    {
+        return view();
+    }
+
+    operator std::string() const
+    {
+        return std::string(view());
+    }
+
+    friend bool operator==(const unescaped_string& lhs, std::string_view rhs)
+    {
+        return lhs.view() == rhs;
+    }
+
+    friend bool operator==(std::string_view lhs, const unescaped_string& rhs)
+    {
+        return lhs == rhs.view();
+    }
+
+    friend bool operator!=(const unescaped_string& lhs, std::string_view rhs)
+    {
+        return lhs.view() != rhs;
+    }
+
+    friend bool operator!=(std::string_view lhs, const unescaped_string& rhs)
+    {
+        return lhs != rhs.view();
+    }
+
+    friend std::ostream& operator<<(std::ostream& output, const unescaped_string& text)
+    {
+        return output << text.view();
+    }
+};
+
 template<char character>
 struct delimiter
 {
@@ -148,6 +780,12 @@ struct has_header
     constexpr static bool value = flag;
 };
 
+template<bool flag>
+struct multiline_cells
+{
+    constexpr static bool value = flag;
+};
+
 template<char... Trim_chars>
 struct trim_chars
 {
@@ -176,36 +814,143 @@ struct trim_chars
     }
 };
 
-class mmap_source
+enum class access_pattern
 {
-    const char* data_{ nullptr };
-    size_t size_;
-    int fd_;
+    normal,
+    sequential, // MADV_SEQUENTIAL, aggressive kernel read-ahead and early reclaim of read pages
+    random,     // MADV_RANDOM, no kernel read-ahead
+    will_need   // MADV_WILLNEED, start reading the whole file in the background
+};
+
+struct mmap_options
+{
+    access_pattern access{ access_pattern::normal };
+    bool populate{ false };    // MAP_POPULATE, fault the whole file in before the constructor returns (Linux only)
+    bool huge_pages{ false };  // MADV_HUGEPAGE, needs read-only THP support of the file system (Linux only)
+    std::size_t read_ahead{ 0 }; // bytes a background thread keeps paged in ahead of the position reported by consumed()
+};
+
+namespace detail
+{
+// touches pages of the mapping on its own thread so page faults are taken off the parsing thread
+class read_ahead
+{
+    const char* const data_;
+    const std::size_t size_;
+    const std::size_t distance_;
+    std::atomic<std::size_t> consumed_{ 0 };
+    std::atomic<std::size_t> prefetched_{ 0 };
+    std::atomic<bool> stop_{ false };
+    std::mutex mutex_;
+    std::condition_variable wake_up_;
+    std::thread thread_;
 
   public:
-    explicit mmap_source(const std::string& path)
+    read_ahead(const char* data, std::size_t size, std::size_t distance)
+        : data_(data)
+        , size_(size)
+        , distance_(distance)
+        , thread_([this] { run(); })
     {
-        fd_ = open(path.c_str(), O_RDONLY | O_CLOEXEC);
-        if (fd_ == -1)
-            throw error{ "can't open file, path: " + path + ", error:" + std::string{ std::strerror(errno) } };
+    }
 
-        struct stat sb = {};
-        if (fstat(fd_, &sb) == -1)
+    read_ahead(const read_ahead&) = delete;
+    read_ahead& operator=(const read_ahead&) = delete;
+
+    void consumed(std::size_t offset)
+    {
+        consumed_.store(offset, std::memory_order_relaxed);
+        if (offset + distance_ / 2 > prefetched_.load(std::memory_order_relaxed) && prefetched_.load() < size_)
+            wake_up_.notify_one();
+    }
+
+    auto prefetched() const
+    {
+        return prefetched_.load();
+    }
+
+    ~read_ahead()
+    {
         {
-            close(fd_);
-            throw error{ "can't get file size, error:" + std::string{ std::strerror(errno) } };
+            std::lock_guard lock{ mutex_ };
+            stop_ = true;
+        }
+        wake_up_.notify_one();
+        thread_.join();
+    }
+
+  private:
+    void run()
+    {
+        const auto page_size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+        std::size_t position = 0;
+        while (!stop_ && position < size_)
+        {
+            const auto target = std::min(size_, consumed_.load(std::memory_order_relaxed) + distance_);
+            if (position >= target)
+            {
+                std::unique_lock lock{ mutex_ };
+                wake_up_.wait_for(lock, std::chrono::milliseconds{ 10 }, [&] {
+                    return stop_ || consumed_.load(std::memory_order_relaxed) + distance_ > position;
+                });
+                continue;
+            }
+
+            for (; position < target && !stop_; position += page_size)
+                static_cast<void>(*static_cast<const volatile char*>(data_ + position));
+            position = std::min(position, target);
+            prefetched_ = position;
+        }
+    }
+};
+} // namespace detail
+
+class mmap_source
+{
+    const char* data_{ nullptr };
+    size_t size_;
+    int fd_;
+    std::uint64_t identity_{ 0 };
+    std::unique_ptr<detail::read_ahead> read_ahead_;
+
+  public:
+    explicit mmap_source(const std::string& path, const mmap_options& options = {})
+    {
+        fd_ = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd_ == -1)
+            throw error{ "can't open file, path: " + path + ", error:" + std::string{ std::strerror(errno) } };
+
+        struct stat sb = {};
+        if (fstat(fd_, &sb) == -1)
+        {
+            close(fd_);
+            throw error{ "can't get file size, error:" + std::string{ std::strerror(errno) } };
         }
 
         size_ = sb.st_size;
+#ifdef __linux__
+        const std::uint64_t modified = sb.st_mtim.tv_sec * 1000000000ULL + sb.st_mtim.tv_nsec;
+#else
+        const std::uint64_t modified = sb.st_mtime;
+#endif
+        identity_ = ((std::uint64_t(sb.st_dev) * 1099511628211ULL) ^ sb.st_ino) * 1099511628211ULL ^ modified;
 
         if (size_ > 0)
         {
-            data_ = static_cast<const char*>(mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0U));
+            auto flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+            if (options.populate)
+                flags |= MAP_POPULATE;
+#endif
+            data_ = static_cast<const char*>(mmap(nullptr, size_, PROT_READ, flags, fd_, 0U));
             if (data_ == MAP_FAILED)
             {
                 close(fd_);
                 throw error{ "can't mmap file, error:" + std::string{ std::strerror(errno) } };
             }
+            advise(options);
+            if (options.read_ahead)
+                read_ahead_ = std::make_unique<detail::read_ahead>(data_, size_, options.read_ahead);
         }
         else
         {
@@ -220,6 +965,8 @@ class mmap_source
         : data_(other.data_)
         , size_(other.size_)
         , fd_(other.fd_)
+        , identity_(other.identity_)
+        , read_ahead_(std::move(other.read_ahead_))
     {
         other.data_ = nullptr;
     }
@@ -229,6 +976,8 @@ class mmap_source
         std::swap(data_, other.data_);
         std::swap(size_, other.size_);
         std::swap(fd_, other.fd_);
+        std::swap(identity_, other.identity_);
+        std::swap(read_ahead_, other.read_ahead_);
         return *this;
     }
 
@@ -242,185 +991,2574 @@ class mmap_source
         return size_;
     }
 
+    // hash of the file's device, inode and modification time, it changes when the file is replaced or rewritten in place
+    auto identity() const
+    {
+        return identity_;
+    }
+
+    // reports the parsing position to the read-ahead thread, it's cheap enough to be called on every row
+    void consumed(const char* position) const
+    {
+        if (read_ahead_)
+            read_ahead_->consumed(position - data_);
+    }
+
+    // end offset of the range paged in by the read-ahead thread
+    std::size_t prefetched() const
+    {
+        return read_ahead_ ? read_ahead_->prefetched() : 0;
+    }
+
     ~mmap_source()
     {
+        read_ahead_.reset();
         if (data_)
         {
             munmap(const_cast<char*>(data_), size_);
             close(fd_);
         }
     }
+
+  private:
+    // advices are hints, failures (e.g. no THP support for the file system) are ignored
+    void advise(const mmap_options& options) const
+    {
+        auto* address = const_cast<char*>(data_);
+        switch (options.access)
+        {
+            case access_pattern::normal:
+                break;
+            case access_pattern::sequential:
+                madvise(address, size_, MADV_SEQUENTIAL);
+                break;
+            case access_pattern::random:
+                madvise(address, size_, MADV_RANDOM);
+                break;
+            case access_pattern::will_need:
+                madvise(address, size_, MADV_WILLNEED);
+                break;
+        }
+#ifdef MADV_HUGEPAGE
+        if (options.huge_pages)
+            madvise(address, size_, MADV_HUGEPAGE);
+#endif
+    }
 };
 
-template<
-    class source = mmap_source,
-    class has_header = has_header<true>,
-    class delimiter = delimiter<','>,
-    class quote_char = quote_char<'"'>,
-    class trim_policy = trim_chars<' ', '\t'>>
-class parser
+// a read only mapping of a file which is only appended to, refresh() extends it as the file grows
+class follow_source
 {
-    source source_;
+    const char* data_{ nullptr };
+    std::size_t size_{ 0 };
+    std::size_t capacity_{ 0 };
+    int fd_{ -1 };
+    int watch_{ -1 }; // inotify descriptor, -1 where it's not available
 
   public:
-    template<typename... Args>
-    explicit parser(Args&&... args)
-        : source_(std::forward<Args>(args)...)
+    explicit follow_source(const std::string& path)
     {
+        fd_ = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd_ == -1)
+            throw error{ "can't open file, path: " + path + ", error:" + std::string{ std::strerror(errno) } };
+#ifdef __linux__
+        watch_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (watch_ != -1 && inotify_add_watch(watch_, path.c_str(), IN_MODIFY) == -1)
+        {
+            close(watch_);
+            watch_ = -1;
+        }
+#endif
+        try
+        {
+            refresh();
+        }
+        catch (...)
+        {
+            release();
+            throw;
+        }
     }
 
-    auto begin() const
+    follow_source(const follow_source&) = delete;
+    follow_source& operator=(const follow_source&) = delete;
+
+    ~follow_source()
     {
-        row_iterator it{ source_.data(), source_.data() + source_.size() };
-        if constexpr (has_header::value)
-            ++it;
-        return it;
+        release();
     }
 
-    auto end() const
+    const auto* data() const
     {
-        auto pos = source_.data() + source_.size() + 1;
-        if (source_.size() && *(pos - 2) == '\n') // skip the last new line if exists
-            pos--;
-        return row_iterator{ pos, pos };
+        return data_;
     }
 
-    auto header() const
+    auto size() const
     {
-        return *row_iterator{ source_.data(), source_.data() + source_.size() };
+        return size_;
     }
 
-    auto index_of(std::string_view column_name) const
+    // returns true if the file has grown, the mapping is reserved with spare capacity so data() rarely moves
+    bool refresh()
     {
-        int index = 0;
-        for (const auto cell : header())
+        struct stat sb = {};
+        if (fstat(fd_, &sb) == -1)
+            throw error{ "can't get file size, error:" + std::string{ std::strerror(errno) } };
+        const auto size = static_cast<std::size_t>(sb.st_size);
+        if (size < size_)
+            throw error{ "followed file was truncated" };
+        if (size == size_)
+            return false;
+
+        if (size > capacity_)
         {
-            if (column_name == cell.trimed())
-                return index;
-            index++;
+            const auto capacity = std::max<std::size_t>(size * 2, 1 << 20);
+            if (data_)
+                munmap(const_cast<char*>(data_), capacity_);
+            // pages past the end of file are never read, MAP_SHARED makes appended bytes visible in the existing pages
+            const auto* data = static_cast<const char*>(mmap(nullptr, capacity, PROT_READ, MAP_SHARED, fd_, 0U));
+            if (data == MAP_FAILED)
+            {
+                data_ = nullptr;
+                capacity_ = size_ = 0;
+                throw error{ "can't mmap file, error:" + std::string{ std::strerror(errno) } };
+            }
+            data_ = data;
+            capacity_ = capacity;
         }
-        throw error{ "Column does not exist" };
+        size_ = size;
+        return true;
     }
 
-    class cell
+    // blocks until the file grows or `timeout` passes, it's notified by inotify on Linux and polls the size elsewhere
+    bool wait(std::chrono::milliseconds timeout)
     {
-        const char* begin_{ nullptr };
-        const char* end_{ nullptr };
-
-      public:
-        cell() = default;
-
-        cell(const char* begin, const char* end)
-            : begin_(escape_leading_quote(begin, end))
-            , end_(escape_trailing_quote(begin, end))
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (!refresh())
         {
+            const auto remaining =
+                std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+            if (remaining <= 0)
+                return false;
+            if (watch_ == -1)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds{ std::min<long long>(remaining, 10) });
+                continue;
+            }
+            pollfd descriptor{ watch_, POLLIN, 0 };
+            if (poll(&descriptor, 1, static_cast<int>(remaining)) > 0)
+            {
+                char events[4096];
+                while (read(watch_, events, sizeof(events)) > 0)
+                {
+                }
+            }
         }
+        return true;
+    }
 
-        const auto* operator->() const
-        {
-            return this;
-        }
+  private:
+    void release()
+    {
+        if (data_)
+            munmap(const_cast<char*>(data_), capacity_);
+        if (watch_ != -1)
+            close(watch_);
+        close(fd_);
+    }
+};
 
-        auto raw() const
-        {
-            return std::string_view(begin_, end_ - begin_);
-        }
+// reads from a file descriptor, pipes and stdin included
+class fd_reader
+{
+    int fd_;
+    bool owned_;
 
-        auto trimed() const
-        {
-            auto [trimed_begin, trimed_end] = trim_policy::trim(begin_, end_);
-            return std::string_view(trimed_begin, trimed_end - trimed_begin);
-        }
+  public:
+    explicit fd_reader(int fd)
+        : fd_(fd)
+        , owned_(false)
+    {
+    }
 
-        auto unescaped() const
+    explicit fd_reader(const std::string& path)
+        : fd_(open(path.c_str(), O_RDONLY | O_CLOEXEC))
+        , owned_(true)
+    {
+        if (fd_ == -1)
+            throw error{ "can't open file, path: " + path + ", error:" + std::string{ std::strerror(errno) } };
+    }
+
+    fd_reader(const fd_reader&) = delete;
+    fd_reader& operator=(const fd_reader&) = delete;
+
+    fd_reader(fd_reader&& other) noexcept
+        : fd_(other.fd_)
+        , owned_(other.owned_)
+    {
+        other.owned_ = false;
+    }
+
+    fd_reader& operator=(fd_reader&& other) noexcept
+    {
+        std::swap(fd_, other.fd_);
+        std::swap(owned_, other.owned_);
+        return *this;
+    }
+
+    std::size_t operator()(char* buffer, std::size_t size)
+    {
+        for (;;)
         {
-            auto [trimed_begin, trimed_end] = trim_policy::trim(begin_, end_);
-            std::string result;
-            result.reserve(trimed_end - trimed_begin);
-            for (const auto* i = trimed_begin; i < trimed_end; i++)
-            {
-                if (*i == quote_char::value && i + 1 < trimed_end && *(i + 1) == quote_char::value)
-                    i++;
-                result.push_back(*i);
-            }
-            return result;
+            const auto result = read(fd_, buffer, size);
+            if (result >= 0)
+                return static_cast<std::size_t>(result);
+            if (errno != EINTR)
+                throw error{ "can't read file, error:" + std::string{ std::strerror(errno) } };
         }
+    }
 
-      private:
-        static const auto* escape_leading_quote(const char* begin, const char* end)
-        {
-            if (end - begin >= 2 && *begin == quote_char::value && *(end - 1) == quote_char::value)
-                return begin + 1;
+    ~fd_reader()
+    {
+        if (owned_)
+            close(fd_);
+    }
+};
 
-            return begin;
-        }
+// writes to a file descriptor, the file is created or truncated when it's opened by path
+class fd_writer
+{
+    int fd_;
+    bool owned_;
 
-        static const auto* escape_trailing_quote(const char* begin, const char* end)
-        {
-            if (end - begin >= 2 && *begin == quote_char::value && *(end - 1) == quote_char::value)
-                return end - 1;
+  public:
+    explicit fd_writer(int fd)
+        : fd_(fd)
+        , owned_(false)
+    {
+    }
 
-            return end;
-        }
-    };
+    explicit fd_writer(const std::string& path)
+        : fd_(open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644))
+        , owned_(true)
+    {
+        if (fd_ == -1)
+            throw error{ "can't open file, path: " + path + ", error:" + std::string{ std::strerror(errno) } };
+    }
 
-    using cell_iterator = detail::fw_iterator<cell, detail::chunk_cells<delimiter::value, quote_char::value>>;
+    fd_writer(const fd_writer&) = delete;
+    fd_writer& operator=(const fd_writer&) = delete;
 
-    class row
+    fd_writer(fd_writer&& other) noexcept
+        : fd_(other.fd_)
+        , owned_(other.owned_)
     {
-        const char* begin_{ nullptr };
-        const char* end_{ nullptr };
+        other.owned_ = false;
+    }
 
-      public:
-        row() = default;
+    fd_writer& operator=(fd_writer&& other) noexcept
+    {
+        std::swap(fd_, other.fd_);
+        std::swap(owned_, other.owned_);
+        return *this;
+    }
 
-        row(const char* begin, const char* end)
-            : begin_(begin)
-            , end_(end)
+    void operator()(const char* data, std::size_t size)
+    {
+        while (size)
         {
+            const auto result = write(fd_, data, size);
+            if (result < 0 && errno == EINTR)
+                continue;
+            if (result < 0)
+                throw error{ "can't write file, error:" + std::string{ std::strerror(errno) } };
+            data += result;
+            size -= static_cast<std::size_t>(result);
         }
+    }
 
-        const auto* operator->() const
+    // closes an owned descriptor, close(2) may report write errors that were deferred, e.g. on network file systems
+    void close()
+    {
+        if (owned_)
         {
-            return this;
+            owned_ = false;
+            if (::close(fd_) == -1)
+                throw error{ "can't close file, error:" + std::string{ std::strerror(errno) } };
         }
+    }
 
-        auto raw() const
+    ~fd_writer()
+    {
+        if (owned_)
+            ::close(fd_);
+    }
+};
+
+// a sliding window over a stream, `reader` is any callable filling a buffer like read(2) and returning 0 at the end
+template<class reader = fd_reader>
+class stream_source
+{
+    struct aligned_delete
+    {
+        void operator()(char* buffer) const
         {
-            return std::string_view(begin_, end_ - begin_);
+            ::operator delete[](buffer, std::align_val_t{ 64 });
         }
+    };
 
-        template<typename... Indexes>
-        auto cells(Indexes... indexes) const
-        {
-            std::array<cell, sizeof...(Indexes)> results;
-            std::array<int, sizeof...(Indexes)> desired_indexes{ indexes... };
+    reader reader_;
+    std::unique_ptr<char[], aligned_delete> buffer_;
+    std::size_t capacity_;
+    std::size_t size_{ 0 };
+    bool eof_{ false };
 
-            auto desired_indexes_it = desired_indexes.begin();
-            auto index = 0;
-            for (const auto cell : *this)
-            {
-                if (index++ == *desired_indexes_it)
-                {
-                    results[desired_indexes_it - desired_indexes.begin()] = cell;
-                    if (++desired_indexes_it == desired_indexes.end())
-                        return results;
-                }
-            }
-            throw error{ "Row has fewer cells than desired" };
-        }
+  public:
+    explicit stream_source(reader input, std::size_t capacity = 4 << 20)
+        : reader_(std::move(input))
+        , buffer_(allocate(capacity))
+        , capacity_(capacity)
+    {
+    }
 
-        auto begin() const
+    const char* data() const
+    {
+        return buffer_.get();
+    }
+
+    auto size() const
+    {
+        return size_;
+    }
+
+    auto capacity() const
+    {
+        return capacity_;
+    }
+
+    auto eof() const
+    {
+        return eof_;
+    }
+
+    // moves [keep, data() + size()) to the front of the buffer and reads more after it, the buffer grows only for rows wider than it
+    const char* refill(const char* keep)
+    {
+        const auto kept = static_cast<std::size_t>(data() + size_ - keep);
+        if (kept == capacity_)
         {
-            return cell_iterator{ begin_, end_ };
+            auto buffer = allocate(capacity_ * 2);
+            std::memcpy(buffer.get(), keep, kept);
+            buffer_ = std::move(buffer);
+            capacity_ *= 2;
         }
-
-        auto end() const
+        else if (kept)
         {
-            return cell_iterator{ end_ + 1, end_ + 1 };
+            std::memmove(buffer_.get(), keep, kept);
         }
-    };
+        size_ = kept;
 
-    using row_iterator = detail::fw_iterator<row, detail::chunk_rows>;
+        while (size_ < capacity_)
+        {
+            const auto read = reader_(buffer_.get() + size_, capacity_ - size_);
+            if (read == 0)
+            {
+                eof_ = true;
+                break;
+            }
+            size_ += read;
+            if (std::memchr(buffer_.get() + size_ - read, '\n', read))
+                break;
+        }
+        return data();
+    }
+
+  private:
+    static std::unique_ptr<char[], aligned_delete> allocate(std::size_t capacity)
+    {
+        return std::unique_ptr<char[], aligned_delete>{ static_cast<char*>(::operator new[](capacity, std::align_val_t{ 64 })) };
+    }
+};
+
+// Elias-Fano encoded, non-decreasing row offsets: about 2 + log2(average row length) bits per row with O(1) access
+class row_index
+{
+    constexpr static std::uint64_t sample_rate = 256;
+    constexpr static char magic[8] = { 'l', 'z', 'c', 's', 'v', 'i', 'x', '2' };
+    constexpr static std::size_t header_size = sizeof(magic) + 7 * sizeof(std::uint64_t);
+
+    std::uint64_t size_{ 0 };
+    std::uint64_t low_width_{ 0 };
+    std::uint64_t fingerprint_{ 0 };
+    std::uint64_t dialect_{ 0 };
+    std::vector<std::uint64_t> low_;
+    std::vector<std::uint64_t> high_;
+    std::vector<std::uint64_t> samples_; // position of every sample_rate-th set bit in high_
+
+  public:
+    row_index() = default;
+
+    row_index(std::uint64_t low_width, std::uint64_t fingerprint, std::uint64_t dialect)
+        : low_width_(low_width)
+        , fingerprint_(fingerprint)
+        , dialect_(dialect)
+    {
+    }
+
+    void push_back(std::uint64_t offset)
+    {
+        if (low_width_)
+        {
+            const auto bit = size_ * low_width_;
+            low_.resize((bit + low_width_ + 63) / 64);
+            const auto low = offset & low_mask();
+            low_[bit / 64] |= low << (bit % 64);
+            if (bit % 64 + low_width_ > 64)
+                low_[bit / 64 + 1] |= low >> (64 - bit % 64);
+        }
+
+        const auto position = (offset >> low_width_) + size_;
+        if (position / 64 >= high_.size())
+            high_.resize(position / 64 + 1);
+        high_[position / 64] |= std::uint64_t{ 1 } << (position % 64);
+
+        if (size_ % sample_rate == 0)
+            samples_.push_back(position);
+        size_++;
+    }
+
+    auto size() const
+    {
+        return size_;
+    }
+
+    auto fingerprint() const
+    {
+        return fingerprint_;
+    }
+
+    auto dialect() const
+    {
+        return dialect_;
+    }
+
+    std::uint64_t operator[](std::uint64_t index) const
+    {
+        return value(index, select(index));
+    }
+
+    // offsets at `index` and `index + 1`, cheaper than two separate lookups
+    std::pair<std::uint64_t, std::uint64_t> adjacent(std::uint64_t index) const
+    {
+        const auto position = select(index);
+        return { value(index, position), value(index + 1, next_set_bit(position)) };
+    }
+
+    void save(const std::string& path) const
+    {
+        std::ofstream file{ path, std::ios::binary | std::ios::trunc };
+        const std::uint64_t fields[] = { size_, low_width_, fingerprint_, dialect_, low_.size(), high_.size(), samples_.size() };
+        file.write(magic, sizeof(magic));
+        file.write(reinterpret_cast<const char*>(fields), sizeof(fields));
+        for (const auto* words : { &low_, &high_, &samples_ })
+            file.write(reinterpret_cast<const char*>(words->data()), words->size() * sizeof(std::uint64_t));
+        if (!file.flush())
+            throw error{ "can't write index file, path: " + path };
+    }
+
+    // returns std::nullopt for missing, truncated or inconsistent files, nothing is allocated before the sizes are validated
+    static std::optional<row_index> load(const std::string& path)
+    {
+        std::ifstream file{ path, std::ios::binary | std::ios::ate };
+        const std::uint64_t length = file ? static_cast<std::uint64_t>(file.tellg()) : 0;
+        char file_magic[sizeof(magic)] = {};
+        std::uint64_t fields[7] = {};
+        file.seekg(0);
+        file.read(file_magic, sizeof(file_magic));
+        file.read(reinterpret_cast<char*>(fields), sizeof(fields));
+        if (!file || !std::equal(std::begin(magic), std::end(magic), file_magic))
+            return std::nullopt;
+
+        const auto [size, low_width, fingerprint, dialect, low_words, high_words, sample_words] = fields;
+        const auto word_count = (length - header_size) / sizeof(std::uint64_t);
+        if (low_width >= 64 || high_words > word_count || size > high_words * 64 || low_words != (size * low_width + 63) / 64
+            || sample_words != (size + sample_rate - 1) / sample_rate
+            || length != header_size + (low_words + high_words + sample_words) * sizeof(std::uint64_t))
+            return std::nullopt;
+
+        row_index index{ low_width, fingerprint, dialect };
+        index.size_ = size;
+        const auto* sizes = fields + 4;
+        for (auto* words : { &index.low_, &index.high_, &index.samples_ })
+        {
+            words->resize(*sizes++);
+            file.read(reinterpret_cast<char*>(words->data()), words->size() * sizeof(std::uint64_t));
+        }
+        if (!file || !index.consistent())
+            return std::nullopt;
+        return index;
+    }
+
+    // packs the parser options that decide where rows start, an index is only reused by a parser with the same dialect
+    constexpr static std::uint64_t dialect_of(bool has_header, bool multiline_cells, char delimiter, char quote_char)
+    {
+        return std::uint64_t{ has_header } | std::uint64_t{ multiline_cells } << 1 | std::uint64_t(static_cast<unsigned char>(delimiter)) << 8
+            | std::uint64_t(static_cast<unsigned char>(quote_char)) << 16;
+    }
+
+    // identifies the indexed data by its size, blocks sampled across the whole data and its tail, where appends show up;
+    // sources backed by a file also pass their identity() so in-place edits between the sampled blocks are noticed
+    static std::uint64_t fingerprint_of(const char* data, std::size_t size, std::uint64_t identity = 0)
+    {
+        constexpr std::size_t blocks = 64;
+        constexpr std::size_t block_size = 64;
+        constexpr std::size_t tail_size = 4096;
+
+        std::uint64_t hash = (14695981039346656037ULL ^ size) * 1099511628211ULL ^ identity;
+        const auto mix = [&hash](const char* first, const char* last) {
+            for (; first < last; first++)
+                hash = (hash ^ static_cast<unsigned char>(*first)) * 1099511628211ULL;
+        };
+        if (size > tail_size)
+        {
+            const auto stride = (size - tail_size) / blocks;
+            for (std::size_t block = 0; block < blocks && stride; block++)
+                mix(data + block * stride, data + block * stride + std::min(stride, block_size));
+        }
+        mix(data + size - std::min(size, tail_size), data + size);
+        return hash;
+    }
+
+  private:
+    // every offset has a set bit in high_ and every sample points at the right one, so select() stays within high_
+    bool consistent() const
+    {
+        std::uint64_t ones = 0;
+        for (std::size_t word_index = 0; word_index < high_.size(); word_index++)
+        {
+            for (auto word = high_[word_index]; word; word &= word - 1)
+            {
+                if (ones == size_)
+                    return false;
+                if (ones % sample_rate == 0 && samples_[ones / sample_rate] != word_index * 64 + __builtin_ctzll(word))
+                    return false;
+                ones++;
+            }
+        }
+        return ones == size_;
+    }
+
+    std::uint64_t low_mask() const
+    {
+        return (std::uint64_t{ 1 } << low_width_) - 1;
+    }
+
+    std::uint64_t low(std::uint64_t index) const
+    {
+        if (!low_width_)
+            return 0;
+        const auto bit = index * low_width_;
+        auto low = low_[bit / 64] >> (bit % 64);
+        if (bit % 64 + low_width_ > 64)
+            low |= low_[bit / 64 + 1] << (64 - bit % 64);
+        return low & low_mask();
+    }
+
+    std::uint64_t value(std::uint64_t index, std::uint64_t position) const
+    {
+        return ((position - index) << low_width_) | low(index);
+    }
+
+    std::uint64_t select(std::uint64_t index) const
+    {
+        const auto sample = samples_[index / sample_rate];
+        auto remaining = index % sample_rate;
+        auto word_index = sample / 64;
+        auto word = high_[word_index] & (~std::uint64_t{ 0 } << (sample % 64));
+        for (auto ones = std::uint64_t(__builtin_popcountll(word)); remaining >= ones; ones = __builtin_popcountll(word))
+        {
+            remaining -= ones;
+            word = high_[++word_index];
+        }
+        for (; remaining; remaining--)
+            word &= word - 1;
+        return word_index * 64 + __builtin_ctzll(word);
+    }
+
+    std::uint64_t next_set_bit(std::uint64_t position) const
+    {
+        auto word_index = (position + 1) / 64;
+        auto word = high_[word_index] & (~std::uint64_t{ 0 } << ((position + 1) % 64));
+        while (!word)
+            word = high_[++word_index];
+        return word_index * 64 + __builtin_ctzll(word);
+    }
+};
+
+// maps a column name to a struct member, e.g. column{ "population", &city::population }
+template<class T, class Member>
+struct column
+{
+    std::string_view name;
+    Member T::*member;
+};
+
+template<class T, class Member>
+column(const char*, Member T::*) -> column<T, Member>;
+
+// decodes rows into T, the column names are resolved once and every row is chunked in a single pass
+template<class parser, class T, class... Members>
+class binding
+{
+    using cell = typename parser::cell;
+    using row = typename parser::row;
+    using columns = std::tuple<column<T, Members>...>;
+    using assign_function = void (*)(const columns&, const cell&, T&);
+
+    struct target
+    {
+        int index;
+        assign_function assign;
+    };
+
+    columns columns_;
+    std::array<target, sizeof...(Members)> targets_;
+
+  public:
+    using value_type = T;
+
+    binding(const std::array<int, sizeof...(Members)>& indexes, column<T, Members>... columns)
+        : columns_(columns...)
+        , targets_(make_targets(indexes, std::index_sequence_for<Members...>{}))
+    {
+        std::sort(targets_.begin(), targets_.end(), [](const auto& lhs, const auto& rhs) { return lhs.index < rhs.index; });
+    }
+
+    void decode(const row& input, T& output) const
+    {
+        auto target = targets_.begin();
+        int index = 0;
+        for (const auto cell : input)
+        {
+            for (; target != targets_.end() && target->index == index; ++target)
+                target->assign(columns_, cell, output);
+            if (target == targets_.end())
+                return;
+            index++;
+        }
+        if (target != targets_.end())
+            throw error{ "Row has fewer cells than the bound columns" };
+    }
+
+    T decode(const row& input) const
+    {
+        T output{};
+        decode(input, output);
+        return output;
+    }
+
+  private:
+    template<std::size_t... I>
+    static auto make_targets(const std::array<int, sizeof...(Members)>& indexes, std::index_sequence<I...>)
+    {
+        return std::array<target, sizeof...(Members)>{ target{ indexes[I], &assign<I> }... };
+    }
+
+    template<std::size_t I>
+    static void assign(const columns& bound_columns, const cell& input, T& output)
+    {
+        convert(input, output.*(std::get<I>(bound_columns).member));
+    }
+
+    template<class Member>
+    static void convert(const cell& input, Member& output)
+    {
+        if constexpr (std::is_same_v<Member, cell>)
+            output = input;
+        else if constexpr (std::is_same_v<Member, std::string_view>)
+            output = input.trimed();
+        else if constexpr (std::is_same_v<Member, std::string>)
+        {
+            if (const auto text = input.unescape_into(output); text.data() != output.data())
+                output.assign(text);
+        }
+        else if constexpr (std::is_assignable_v<Member&, std::string_view>)
+            output = input.unescaped().view(); // owning string types of other libraries
+        else
+        {
+            const auto result = input.template as<Member>();
+            if (!result)
+                throw error{ "Cell is not a valid number" };
+            output = result.value;
+        }
+    }
+};
+
+// an 8 byte handle of a row or a cell relative to the start of the data of its parser, half the size of the views
+// `offset_bits` keep the offset and the rest keep the size, 32 bits allow 4 GiB sources and 48 bits allow 256 TiB
+// sources with rows and cells up to 64 KiB
+template<unsigned offset_bits = 32>
+class compact_range
+{
+    static_assert(offset_bits > 0 && offset_bits < 64, "Both the offset and the size need bits");
+
+    std::uint64_t packed_{ 0 };
+
+  public:
+    compact_range() = default;
+
+    compact_range(std::size_t offset, std::size_t size)
+    {
+        if (static_cast<std::uint64_t>(offset) >> offset_bits || static_cast<std::uint64_t>(size) >> (64 - offset_bits))
+            throw error{ "Range doesn't fit in a compact handle" };
+        packed_ = static_cast<std::uint64_t>(offset) | static_cast<std::uint64_t>(size) << offset_bits;
+    }
+
+    std::size_t offset() const
+    {
+        return static_cast<std::size_t>(packed_ & ((std::uint64_t{ 1 } << offset_bits) - 1));
+    }
+
+    std::size_t size() const
+    {
+        return static_cast<std::size_t>(packed_ >> offset_bits);
+    }
+
+    bool operator==(const compact_range& rhs) const
+    {
+        return packed_ == rhs.packed_;
+    }
+
+    bool operator!=(const compact_range& rhs) const
+    {
+        return packed_ != rhs.packed_;
+    }
+};
+
+// counters aggregated by parser::validate()
+struct row_stats
+{
+    std::uint64_t rows{ 0 };
+    std::uint64_t bad_rows{ 0 };
+    std::size_t max_cells{ 0 };
+};
+
+// strings stored back to back in a single buffer, the string at `index` spans [offsets()[index], offsets()[index + 1])
+class string_column
+{
+    std::string data_;
+    std::vector<std::size_t> offsets_{ 0 };
+
+  public:
+    void push_back(std::string_view value)
+    {
+        data_.append(value);
+        offsets_.push_back(data_.size());
+    }
+
+    void resize(std::size_t count)
+    {
+        offsets_.resize(count + 1, data_.size());
+        data_.resize(offsets_.back());
+    }
+
+    auto size() const
+    {
+        return offsets_.size() - 1;
+    }
+
+    auto operator[](std::size_t index) const
+    {
+        return std::string_view(data_.data() + offsets_[index], offsets_[index + 1] - offsets_[index]);
+    }
+
+    const auto& data() const
+    {
+        return data_;
+    }
+
+    const auto& offsets() const
+    {
+        return offsets_;
+    }
+};
+
+template<
+    class source = mmap_source,
+    class has_header = has_header<true>,
+    class delimiter = delimiter<','>,
+    class quote_char = quote_char<'"'>,
+    class trim_policy = trim_chars<' ', '\t'>,
+    class multiline_cells = multiline_cells<false>>
+class parser
+{
+    constexpr static auto dialect = row_index::dialect_of(has_header::value, multiline_cells::value, delimiter::value, quote_char::value);
+
+    source source_;
+    row_index index_;
+
+  public:
+    template<typename... Args>
+    explicit parser(Args&&... args)
+        : source_(std::forward<Args>(args)...)
+    {
+    }
+
+    const auto& data_source() const
+    {
+        return source_;
+    }
+
+    auto begin() const
+    {
+        row_iterator it{ source_.data(), source_.data() + source_.size() };
+        if constexpr (has_header::value)
+            ++it;
+        return it;
+    }
+
+    auto end() const
+    {
+        auto pos = source_.data() + source_.size() + 1;
+        if (source_.size() && *(pos - 2) == '\n') // skip the last new line if exists
+            pos--;
+        return row_iterator{ pos, pos };
+    }
+
+    auto header() const
+    {
+        return *row_iterator{ source_.data(), source_.data() + source_.size() };
+    }
+
+    auto index_of(std::string_view column_name) const
+    {
+        int index = 0;
+        for (const auto cell : header())
+        {
+            if (column_name == cell.trimed())
+                return index;
+            index++;
+        }
+        throw error{ "Column does not exist" };
+    }
+
+    // resolves several column names with a single pass over the header
+    template<typename... Names>
+    auto indexes_of(Names... column_names) const
+    {
+        const tokenized_row header_cells{ header() };
+        std::array<std::string_view, sizeof...(Names)> names{ column_names... };
+        std::array<int, sizeof...(Names)> indexes{};
+        for (std::size_t i = 0; i < names.size(); i++)
+        {
+            indexes[i] = -1;
+            for (std::size_t column = 0; column < header_cells.size() && indexes[i] == -1; column++)
+            {
+                if (names[i] == header_cells[column].trimed())
+                    indexes[i] = static_cast<int>(column);
+            }
+            if (indexes[i] == -1)
+                throw error{ "Column does not exist" };
+        }
+        return indexes;
+    }
+
+    // resolves the columns against the header, the returned binding decodes rows of this parser into T
+    template<class T, class... Members>
+    auto bind(column<T, Members>... columns) const
+    {
+        return binding<parser, T, Members...>{ indexes_of(columns.name...), columns... };
+    }
+
+    // a single scan extracting the named columns, e.g. project<double, std::string>("price", "name")
+    template<class... Types, class... Names>
+    auto project(Names... column_names) const
+    {
+        static_assert(sizeof...(Types) == sizeof...(Names), "each projected column needs a type");
+        projection<Types...> result{ indexes_of(column_names...) };
+        for (const auto row : *this)
+            result.append(row);
+        return result;
+    }
+
+    // one pass over the rows to enable random access with row_at() and indexed_rows()
+    void build_index()
+    {
+        const auto* const data = source_.data();
+        auto it = begin();
+        const auto last = end();
+
+        // Elias-Fano low bits width is log2 of the average row length, it's estimated with the first rows
+        auto sample = it;
+        std::uint64_t sampled_rows = 0;
+        for (; sample != last && sampled_rows < 64; ++sample)
+            sampled_rows++;
+        const std::uint64_t average_length = sampled_rows ? (sample->raw().data() - it->raw().data()) / sampled_rows : 0;
+        const std::uint64_t low_width = average_length > 1 ? 63 - __builtin_clzll(average_length) : 0;
+
+        row_index index{ low_width, fingerprint(), dialect };
+        for (;; ++it)
+        {
+            index.push_back(it->raw().data() - data);
+            if (it == last)
+                break;
+        }
+        index_ = std::move(index);
+    }
+
+    // loads the index from `index_path` if it matches the source, otherwise builds and saves it there
+    void build_index(const std::string& index_path)
+    {
+        auto index = row_index::load(index_path);
+        if (index && index->fingerprint() == fingerprint() && index->dialect() == dialect && index->size()
+            && (*index)[index->size() - 1] <= source_.size() + 1)
+        {
+            index_ = std::move(*index);
+            return;
+        }
+        build_index();
+        index_.save(index_path);
+    }
+
+    const auto& index() const
+    {
+        return index_;
+    }
+
+    std::size_t row_count() const
+    {
+        return index_.size() ? index_.size() - 1 : 0;
+    }
+
+    auto row_at(std::size_t index) const
+    {
+        if (index >= row_count())
+            throw error{ "Row index is out of range, build_index() is needed before random access" };
+        const auto [begin, next] = index_.adjacent(index);
+        return row{ source_.data() + begin, source_.data() + next - 1 };
+    }
+
+    auto indexed_rows() const
+    {
+        return detail::iterator_range<indexed_row_iterator>{ { this, 0 }, { this, static_cast<std::ptrdiff_t>(row_count()) } };
+    }
+
+    // splits rows into at most `count` byte ranges which start and end at row boundaries, they can be iterated concurrently
+    auto shards(std::size_t count) const
+    {
+        std::vector<shard> results;
+        if (count == 0 || source_.size() == 0)
+            return results;
+
+        const auto* const body = first_row();
+        const auto* const dead_end = source_.data() + source_.size();
+        const auto* begin = body;
+        std::uint64_t inside = 0; // quote state at `scanned`
+        const auto* scanned = body;
+        for (std::size_t i = 1; i <= count && begin < dead_end; i++)
+        {
+            const auto* cut = body + (dead_end - body) * i / count;
+            if (cut <= begin)
+                continue;
+
+            const auto* end = dead_end;
+            if (cut != dead_end)
+            {
+                if constexpr (multiline_cells::value)
+                {
+                    inside ^= detail::simd::quote_parity(scanned, cut - 1, quote_char::value);
+                    const auto* new_line = detail::simd::find_unquoted(cut - 1, dead_end, quote_char::value, '\n', inside);
+                    end = std::min(new_line + 1, dead_end);
+                    inside = 0;
+                    scanned = end;
+                }
+                else if (const auto* new_line = static_cast<const char*>(memchr(cut - 1, '\n', dead_end - cut + 1)))
+                {
+                    end = new_line + 1;
+                }
+            }
+
+            if (end > begin)
+                results.emplace_back(begin, end);
+            begin = end;
+        }
+        return results;
+    }
+
+    class cell
+    {
+        const char* begin_{ nullptr };
+        const char* end_{ nullptr };
+
+      public:
+        cell() = default;
+
+        cell(const char* begin, const char* end)
+            : begin_(escape_leading_quote(begin, end))
+            , end_(escape_trailing_quote(begin, end))
+        {
+        }
+
+        const auto* operator->() const
+        {
+            return this;
+        }
+
+        auto raw() const
+        {
+            return std::string_view(begin_, end_ - begin_);
+        }
+
+        auto trimed() const
+        {
+            auto [trimed_begin, trimed_end] = trim_policy::trim(begin_, end_);
+            return std::string_view(trimed_begin, trimed_end - trimed_begin);
+        }
+
+        // a view into the source for cells without escaped quotes, only those are copied
+        auto unescaped() const
+        {
+            const auto text = trimed();
+            if (!has_escapes(text))
+                return unescaped_string{ text };
+            std::string result;
+            result.reserve(text.size());
+            unescape_into(result);
+            return unescaped_string{ std::move(result) };
+        }
+
+        // a view into the source for cells without escaped quotes, otherwise the cell is unescaped into `buffer` and the
+        // view refers to it, the storage of `buffer` is reused across calls
+        template<class buffer>
+        std::string_view unescape_into(buffer& output) const
+        {
+            const auto text = trimed();
+            if (!has_escapes(text))
+                return text;
+            output.clear();
+            for (auto i = text.begin(); i < text.end(); i++)
+            {
+                if (*i == quote_char::value && i + 1 < text.end() && *(i + 1) == quote_char::value)
+                    i++;
+                output.push_back(*i);
+            }
+            return std::string_view(output.data(), output.size());
+        }
+
+        // parses the trimed cell as an integer or floating point number, errors are reported in the result
+        template<class T>
+        auto as() const
+        {
+            static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>, "only numeric types are supported");
+            const auto text = trimed();
+            conversion_result<T> result;
+            result.error = detail::from_chars(text.data(), text.data() + text.size(), result.value);
+            return result;
+        }
+
+      private:
+        // quotes left after removing the enclosing ones can only be escapes, memchr is vectorized by the C library
+        static bool has_escapes(std::string_view text)
+        {
+            return !text.empty() && std::memchr(text.data(), quote_char::value, text.size());
+        }
+
+        static const auto* escape_leading_quote(const char* begin, const char* end)
+        {
+            if (end - begin >= 2 && *begin == quote_char::value && *(end - 1) == quote_char::value)
+                return begin + 1;
+
+            return begin;
+        }
+
+        static const auto* escape_trailing_quote(const char* begin, const char* end)
+        {
+            if (end - begin >= 2 && *begin == quote_char::value && *(end - 1) == quote_char::value)
+                return end - 1;
+
+            return end;
+        }
+    };
+
+    using cell_iterator = detail::fw_iterator<cell, detail::simd_chunk_cells<delimiter::value, quote_char::value>>;
+
+    class row
+    {
+        const char* begin_{ nullptr };
+        const char* end_{ nullptr };
+
+      public:
+        row() = default;
+
+        row(const char* begin, const char* end)
+            : begin_(begin)
+            , end_(end)
+        {
+        }
+
+        const auto* operator->() const
+        {
+            return this;
+        }
+
+        auto raw() const
+        {
+            return std::string_view(begin_, end_ - begin_);
+        }
+
+        template<typename... Indexes>
+        auto cells(Indexes... indexes) const
+        {
+            auto results = try_cells(indexes...);
+            if (!results)
+                throw error{ "Row has fewer cells than desired" };
+            return *results;
+        }
+
+        // same as cells() but returns an empty optional for short rows instead of throwing
+        template<typename... Indexes>
+        auto try_cells(Indexes... indexes) const -> std::optional<std::array<cell, sizeof...(Indexes)>>
+        {
+            std::array<cell, sizeof...(Indexes)> results;
+            std::array<int, sizeof...(Indexes)> desired_indexes{ indexes... };
+
+            auto desired_indexes_it = desired_indexes.begin();
+            auto index = 0;
+            for (const auto cell : *this)
+            {
+                if (index++ == *desired_indexes_it)
+                {
+                    results[desired_indexes_it - desired_indexes.begin()] = cell;
+                    if (++desired_indexes_it == desired_indexes.end())
+                        return results;
+                }
+            }
+            return std::nullopt;
+        }
+
+        auto begin() const
+        {
+            return cell_iterator{ begin_, end_ };
+        }
+
+        auto end() const
+        {
+            return cell_iterator{ end_ + 1, end_ + 1 };
+        }
+    };
+
+    // a row split into cells once, cells are accessible by index in constant time
+    class tokenized_row
+    {
+        const char* end_{ nullptr };
+        detail::small_vector<const char*, 32> cell_begins_;
+
+      public:
+        tokenized_row() = default;
+
+        explicit tokenized_row(const row& row)
+        {
+            assign(row);
+        }
+
+        // reuses the already allocated storage of wide rows
+        void assign(const row& row)
+        {
+            const auto raw = row.raw();
+            end_ = raw.data() + raw.size();
+            cell_begins_.clear();
+            cell_begins_.push_back(raw.data());
+            delimiters_inserter inserter{ cell_begins_ };
+            detail::simd::find_all_unquoted(raw.data(), end_, quote_char::value, delimiter::value, inserter);
+        }
+
+        auto size() const
+        {
+            return cell_begins_.size();
+        }
+
+        auto operator[](std::size_t index) const
+        {
+            return cell{ cell_begins_[index], index + 1 < size() ? cell_begins_[index + 1] - 1 : end_ };
+        }
+
+        auto at(std::size_t index) const
+        {
+            if (index >= size())
+                throw error{ "Row has fewer cells than desired" };
+            return (*this)[index];
+        }
+
+        template<typename... Indexes>
+        auto cells(Indexes... indexes) const
+        {
+            return std::array<cell, sizeof...(Indexes)>{ at(indexes)... };
+        }
+
+      private:
+        struct delimiters_inserter
+        {
+            detail::small_vector<const char*, 32>& cell_begins;
+
+            void push_back(const char* delimiter_position)
+            {
+                cell_begins.push_back(delimiter_position + 1);
+            }
+        };
+    };
+
+    // columns extracted into contiguous buffers, numeric columns are stored in std::vector<T> and std::string columns in string_column
+    template<class... Types>
+    class projection
+    {
+        template<class T>
+        using column_type = std::conditional_t<std::is_same_v<T, std::string>, string_column, std::vector<T>>;
+        using columns = std::tuple<column_type<Types>...>;
+        using append_function = void (projection::*)(const cell&);
+
+        columns columns_;
+        std::array<int, sizeof...(Types)> indexes_;
+        std::array<append_function, sizeof...(Types)> appends_;
+        std::size_t size_{ 0 };
+        std::string unescaped_;
+
+      public:
+        explicit projection(const std::array<int, sizeof...(Types)>& indexes)
+        {
+            auto order = make_order(std::index_sequence_for<Types...>{});
+            std::sort(order.begin(), order.end(), [&](auto lhs, auto rhs) { return indexes[lhs] < indexes[rhs]; });
+            const auto appends = make_appends(std::index_sequence_for<Types...>{});
+            for (std::size_t i = 0; i < order.size(); i++)
+            {
+                indexes_[i] = indexes[order[i]];
+                appends_[i] = appends[order[i]];
+            }
+        }
+
+        // appends the projected cells of a row, the columns are left unchanged if the row is short or a cell can't be converted
+        void append(const row& input)
+        {
+            const auto raw = input.raw();
+            try
+            {
+                const auto visited = detail::simd::for_each_cell_at(
+                    raw.data(),
+                    raw.data() + raw.size(),
+                    quote_char::value,
+                    delimiter::value,
+                    indexes_.data(),
+                    indexes_.size(),
+                    [this](std::size_t ordinal, const char* begin, const char* end) { (this->*appends_[ordinal])(cell{ begin, end }); });
+                if (visited != indexes_.size())
+                    throw error{ "Row has fewer cells than the projected columns" };
+            }
+            catch (...)
+            {
+                std::apply([this](auto&... column) { (column.resize(size_), ...); }, columns_);
+                throw;
+            }
+            size_++;
+        }
+
+        auto size() const
+        {
+            return size_;
+        }
+
+        template<std::size_t I>
+        const auto& column() const
+        {
+            return std::get<I>(columns_);
+        }
+
+      private:
+        template<std::size_t... I>
+        static auto make_order(std::index_sequence<I...>)
+        {
+            return std::array<std::size_t, sizeof...(I)>{ I... };
+        }
+
+        template<std::size_t... I>
+        static auto make_appends(std::index_sequence<I...>)
+        {
+            return std::array<append_function, sizeof...(I)>{ &projection::append<I>... };
+        }
+
+        template<std::size_t I>
+        void append(const cell& input)
+        {
+            using T = std::tuple_element_t<I, std::tuple<Types...>>;
+            auto& column = std::get<I>(columns_);
+            if constexpr (std::is_same_v<T, std::string>)
+                column.push_back(input.unescape_into(unescaped_));
+            else if constexpr (std::is_same_v<T, std::string_view>)
+                column.push_back(input.trimed());
+            else
+            {
+                const auto result = input.template as<T>();
+                if (!result)
+                    throw error{ "Cell is not a valid number" };
+                column.push_back(result.value);
+            }
+        }
+    };
+
+    using row_iterator = detail::fw_iterator<
+        row,
+        std::conditional_t<multiline_cells::value, detail::chunk_quoted_rows<quote_char::value>, detail::chunk_rows>>;
+
+    class indexed_row_iterator
+    {
+        const parser* owner_{ nullptr };
+        std::ptrdiff_t index_{ 0 };
+
+      public:
+        using value_type = row;
+        using difference_type = std::ptrdiff_t;
+        using iterator_category = std::random_access_iterator_tag;
+        using pointer = row;
+        using reference = row;
+
+        indexed_row_iterator() = default;
+
+        indexed_row_iterator(const parser* owner, std::ptrdiff_t index)
+            : owner_(owner)
+            , index_(index)
+        {
+        }
+
+        auto operator*() const
+        {
+            return owner_->row_at(index_);
+        }
+
+        auto operator->() const
+        {
+            return owner_->row_at(index_);
+        }
+
+        auto operator[](difference_type n) const
+        {
+            return owner_->row_at(index_ + n);
+        }
+
+        auto& operator++()
+        {
+            ++index_;
+            return *this;
+        }
+
+        auto& operator--()
+        {
+            --index_;
+            return *this;
+        }
+
+        auto operator++(int)
+        {
+            const auto tmp = *this;
+            ++index_;
+            return tmp;
+        }
+
+        auto operator--(int)
+        {
+            const auto tmp = *this;
+            --index_;
+            return tmp;
+        }
+
+        auto& operator+=(difference_type n)
+        {
+            index_ += n;
+            return *this;
+        }
+
+        auto& operator-=(difference_type n)
+        {
+            index_ -= n;
+            return *this;
+        }
+
+        auto operator+(difference_type n) const
+        {
+            return indexed_row_iterator{ owner_, index_ + n };
+        }
+
+        friend auto operator+(difference_type n, const indexed_row_iterator& it)
+        {
+            return it + n;
+        }
+
+        auto operator-(difference_type n) const
+        {
+            return indexed_row_iterator{ owner_, index_ - n };
+        }
+
+        auto operator-(const indexed_row_iterator& rhs) const
+        {
+            return index_ - rhs.index_;
+        }
+
+        bool operator==(const indexed_row_iterator& rhs) const
+        {
+            return index_ == rhs.index_;
+        }
+
+        bool operator!=(const indexed_row_iterator& rhs) const
+        {
+            return index_ != rhs.index_;
+        }
+
+        bool operator<(const indexed_row_iterator& rhs) const
+        {
+            return index_ < rhs.index_;
+        }
+
+        bool operator>(const indexed_row_iterator& rhs) const
+        {
+            return index_ > rhs.index_;
+        }
+
+        bool operator<=(const indexed_row_iterator& rhs) const
+        {
+            return index_ <= rhs.index_;
+        }
+
+        bool operator>=(const indexed_row_iterator& rhs) const
+        {
+            return index_ >= rhs.index_;
+        }
+    };
+
+    class shard
+    {
+        row_iterator begin_;
+        row_iterator end_;
+
+      public:
+        shard(const char* begin, const char* end)
+            : begin_(begin, end)
+            , end_(sentinel(begin, end), sentinel(begin, end))
+        {
+        }
+
+        auto begin() const
+        {
+            return begin_;
+        }
+
+        auto end() const
+        {
+            return end_;
+        }
+
+      private:
+        static const char* sentinel(const char* begin, const char* end)
+        {
+            if (begin != end && *(end - 1) != '\n') // the last row of the source without new line
+                return end + 1;
+            return end;
+        }
+    };
+
+    struct checked_row
+    {
+        row content;
+        std::size_t cell_count;
+        bool malformed; // the cell count differs from the expected one or a quote is left open
+    };
+
+    // an input range of checked_row, the counters cover the rows iterated so far
+    class validator
+    {
+        const parser* owner_;
+        std::size_t expected_cells_;
+        row_stats stats_;
+
+      public:
+        validator(const parser& owner, std::size_t expected_cells)
+            : owner_(&owner)
+            , expected_cells_(expected_cells)
+        {
+        }
+
+        validator(const validator&) = delete;
+        validator& operator=(const validator&) = delete;
+
+        class iterator
+        {
+            validator* owner_{ nullptr };
+            row_iterator it_;
+            row_iterator end_;
+            checked_row current_{};
+
+          public:
+            using value_type = checked_row;
+            using difference_type = std::ptrdiff_t;
+            using iterator_category = std::input_iterator_tag;
+            using pointer = const checked_row*;
+            using reference = const checked_row&;
+
+            iterator(validator* owner, row_iterator it, row_iterator end)
+                : owner_(owner)
+                , it_(it)
+                , end_(end)
+            {
+                if (it_ != end_)
+                    current_ = owner_->check(*it_);
+            }
+
+            auto& operator++()
+            {
+                if (++it_ != end_)
+                    current_ = owner_->check(*it_);
+                return *this;
+            }
+
+            bool operator!=(const iterator& rhs) const
+            {
+                return it_ != rhs.it_;
+            }
+
+            bool operator==(const iterator& rhs) const
+            {
+                return it_ == rhs.it_;
+            }
+
+            const auto& operator*() const
+            {
+                return current_;
+            }
+
+            const auto* operator->() const
+            {
+                return &current_;
+            }
+        };
+
+        auto begin()
+        {
+            return iterator{ this, owner_->begin(), owner_->end() };
+        }
+
+        auto end()
+        {
+            return iterator{ this, owner_->end(), owner_->end() };
+        }
+
+        const auto& stats() const
+        {
+            return stats_;
+        }
+
+      private:
+        checked_row check(const row& input)
+        {
+            const auto raw = input.raw();
+            std::uint64_t inside = 0;
+            const auto cell_count =
+                detail::simd::count_unquoted(raw.data(), raw.data() + raw.size(), quote_char::value, delimiter::value, inside) + 1;
+            const auto malformed = cell_count != expected_cells_ || inside;
+            stats_.rows++;
+            stats_.bad_rows += malformed;
+            stats_.max_cells = std::max(stats_.max_cells, cell_count);
+            return checked_row{ input, cell_count, malformed };
+        }
+    };
+
+    // iterates rows without throwing, each row is tagged with its cell count and whether it differs from `expected_cells`,
+    // which defaults to the cell count of the first row
+    auto validate(std::size_t expected_cells = 0) const
+    {
+        if (expected_cells == 0)
+        {
+            const auto raw = header().raw();
+            std::uint64_t inside = 0;
+            expected_cells =
+                detail::simd::count_unquoted(raw.data(), raw.data() + raw.size(), quote_char::value, delimiter::value, inside) + 1;
+        }
+        return validator{ *this, expected_cells };
+    }
+
+    // a compact handle of a row or a cell of this parser, throws if it doesn't fit in `offset_bits`
+    template<unsigned offset_bits = 32>
+    auto compact(const row& value) const
+    {
+        const auto raw = value.raw();
+        return compact_range<offset_bits>{ static_cast<std::size_t>(raw.data() - source_.data()), raw.size() };
+    }
+
+    template<unsigned offset_bits = 32>
+    auto compact(const cell& value) const
+    {
+        // the enclosing quotes are kept, so expand_cell() strips them again like the cell iterator did
+        const auto raw = value.raw();
+        auto offset = static_cast<std::size_t>(raw.data() - source_.data());
+        auto size = raw.size();
+        if (offset != 0 && source_.data()[offset - 1] == quote_char::value)
+        {
+            offset--;
+            size += 2;
+        }
+        return compact_range<offset_bits>{ offset, size };
+    }
+
+    template<unsigned offset_bits>
+    auto expand_row(const compact_range<offset_bits>& handle) const
+    {
+        const auto* begin = source_.data() + handle.offset();
+        return row{ begin, begin + handle.size() };
+    }
+
+    template<unsigned offset_bits>
+    auto expand_cell(const compact_range<offset_bits>& handle) const
+    {
+        const auto* begin = source_.data() + handle.offset();
+        return cell{ begin, begin + handle.size() };
+    }
+
+  private:
+    const char* first_row() const
+    {
+        if constexpr (has_header::value)
+        {
+            const auto header_raw = header().raw();
+            return std::min(header_raw.data() + header_raw.size() + 1, source_.data() + source_.size());
+        }
+        else
+        {
+            return source_.data();
+        }
+    }
+
+    std::uint64_t fingerprint() const
+    {
+        if constexpr (std::is_same_v<source, mmap_source>)
+            return row_index::fingerprint_of(source_.data(), source_.size(), source_.identity());
+        else
+            return row_index::fingerprint_of(source_.data(), source_.size());
+    }
+};
+
+// rows of a parser kept as compact handles, e.g. to sort or join millions of rows in half the memory of row views
+template<class parser, unsigned offset_bits = 32>
+class compact_rows
+{
+    const parser* csv_;
+    std::vector<compact_range<offset_bits>> handles_;
+
+  public:
+    explicit compact_rows(const parser& csv)
+        : csv_(&csv)
+    {
+    }
+
+    void push_back(const typename parser::row& value)
+    {
+        handles_.push_back(csv_->template compact<offset_bits>(value));
+    }
+
+    auto operator[](std::size_t index) const
+    {
+        return csv_->expand_row(handles_[index]);
+    }
+
+    auto size() const
+    {
+        return handles_.size();
+    }
+
+    void reserve(std::size_t capacity)
+    {
+        handles_.reserve(capacity);
+    }
+
+    // the handles can be reordered in place, e.g. sorted with a comparator which expands them
+    auto& handles()
+    {
+        return handles_;
+    }
+
+    const auto& handles() const
+    {
+        return handles_;
+    }
+};
+
+// a single pass parser over a stream_source, rows and cells are valid until the iterator advances
+template<
+    class source = stream_source<>,
+    class has_header = has_header<true>,
+    class delimiter = delimiter<','>,
+    class quote_char = quote_char<'"'>,
+    class trim_policy = trim_chars<' ', '\t'>,
+    class multiline_cells = multiline_cells<false>>
+class stream_parser
+{
+    using view_parser = parser<std::string_view, has_header, delimiter, quote_char, trim_policy, multiline_cells>;
+
+  public:
+    using cell = typename view_parser::cell;
+    using row = typename view_parser::row;
+    using tokenized_row = typename view_parser::tokenized_row;
+
+  private:
+    source source_;
+    std::string header_;
+    const char* cursor_{ nullptr };
+    row current_;
+
+  public:
+    template<typename... Args>
+    explicit stream_parser(Args&&... args)
+        : source_(std::forward<Args>(args)...)
+    {
+        cursor_ = source_.data();
+        if constexpr (has_header::value)
+        {
+            if (next_row())
+                header_ = current_.raw();
+        }
+    }
+
+    stream_parser(const stream_parser&) = delete;
+    stream_parser& operator=(const stream_parser&) = delete;
+
+    class row_iterator
+    {
+        stream_parser* owner_{ nullptr };
+
+      public:
+        using value_type = row;
+        using difference_type = std::ptrdiff_t;
+        using iterator_category = std::input_iterator_tag;
+        using pointer = row;
+        using reference = row;
+
+        row_iterator() = default;
+
+        explicit row_iterator(stream_parser* owner)
+            : owner_(owner)
+        {
+        }
+
+        auto& operator++()
+        {
+            if (!owner_->next_row())
+                owner_ = nullptr;
+            return *this;
+        }
+
+        bool operator!=(const row_iterator& rhs) const
+        {
+            return owner_ != rhs.owner_;
+        }
+
+        bool operator==(const row_iterator& rhs) const
+        {
+            return owner_ == rhs.owner_;
+        }
+
+        auto operator*() const
+        {
+            return owner_->current_;
+        }
+
+        auto operator->() const
+        {
+            return owner_->current_;
+        }
+    };
+
+    auto begin()
+    {
+        return next_row() ? row_iterator{ this } : row_iterator{};
+    }
+
+    auto end()
+    {
+        return row_iterator{};
+    }
+
+    auto header() const
+    {
+        return row{ header_.data(), header_.data() + header_.size() };
+    }
+
+    auto index_of(std::string_view column_name) const
+    {
+        int index = 0;
+        for (const auto cell : header())
+        {
+            if (column_name == cell.trimed())
+                return index;
+            index++;
+        }
+        throw error{ "Column does not exist" };
+    }
+
+    template<typename... Names>
+    auto indexes_of(Names... column_names) const
+    {
+        return view_parser{ std::string_view{ header_ } }.indexes_of(column_names...);
+    }
+
+    template<class T, class... Members>
+    auto bind(column<T, Members>... columns) const
+    {
+        return binding<stream_parser, T, Members...>{ indexes_of(columns.name...), columns... };
+    }
+
+    template<class... Types, class... Names>
+    auto project(Names... column_names)
+    {
+        static_assert(sizeof...(Types) == sizeof...(Names), "each projected column needs a type");
+        typename view_parser::template projection<Types...> result{ indexes_of(column_names...) };
+        for (const auto row : *this)
+            result.append(row);
+        return result;
+    }
+
+  private:
+    bool next_row()
+    {
+        std::uint64_t inside = 0;
+        for (const auto* scanned = cursor_;;)
+        {
+            const auto* const filled = source_.data() + source_.size();
+            const char* end = nullptr;
+            if constexpr (multiline_cells::value)
+                end = detail::simd::find_unquoted(scanned, filled, quote_char::value, '\n', inside);
+            else
+                end = detail::chunk_rows::chunk(scanned, filled);
+
+            if (end != filled)
+            {
+                current_ = row{ cursor_, end };
+                cursor_ = end + 1;
+                return true;
+            }
+
+            if (source_.eof())
+            {
+                if (cursor_ == filled)
+                    return false;
+                // an unclosed quote, the last new line still ends the row
+                current_ = row{ cursor_, multiline_cells::value && *(filled - 1) == '\n' ? filled - 1 : filled };
+                cursor_ = filled;
+                return true;
+            }
+
+            const auto consumed = filled - cursor_;
+            cursor_ = source_.refill(cursor_);
+            scanned = cursor_ + consumed;
+        }
+    }
+};
+
+// tails a growing file, next_rows() returns the rows completed since the previous call
+template<
+    class has_header = has_header<true>,
+    class delimiter = delimiter<','>,
+    class quote_char = quote_char<'"'>,
+    class trim_policy = trim_chars<' ', '\t'>,
+    class multiline_cells = multiline_cells<false>>
+class follow_parser
+{
+    using view_parser = parser<std::string_view, has_header, delimiter, quote_char, trim_policy, multiline_cells>;
+
+  public:
+    using cell = typename view_parser::cell;
+    using row = typename view_parser::row;
+    using tokenized_row = typename view_parser::tokenized_row;
+
+  private:
+    follow_source source_;
+    std::size_t offset_;
+    std::string header_;
+    bool header_read_{ !has_header::value };
+
+  public:
+    // `offset` resumes a previous session, it's the value of offset() at that time
+    explicit follow_parser(const std::string& path, std::size_t offset = 0)
+        : source_(path)
+        , offset_(offset)
+    {
+    }
+
+    // rows ending with a new line appended since the previous call, the rows of a call are valid until the next one
+    auto next_rows()
+    {
+        source_.refresh();
+        const auto* const data = source_.size() ? source_.data() : ""; // nothing is mapped for empty files
+        const auto* const dead_end = data + source_.size();
+        // a resumed offset past the end means the file was rotated or truncated since, it's followed from its current end
+        offset_ = std::min(offset_, source_.size());
+        if (!header_read_)
+        {
+            const auto* header_end = complete_rows_end(data, dead_end, true);
+            if (header_end == data)
+                return typename view_parser::shard{ data + offset_, data + offset_ };
+            header_.assign(data, header_end - 1);
+            header_read_ = true;
+            offset_ = std::max<std::size_t>(offset_, header_end - data);
+        }
+
+        const auto* const begin = data + offset_;
+        const auto* const end = complete_rows_end(begin, dead_end, false);
+        offset_ = end - data;
+        return typename view_parser::shard{ begin, end };
+    }
+
+    // blocks until the file grows or `timeout` passes
+    bool wait(std::chrono::milliseconds timeout)
+    {
+        return source_.wait(timeout);
+    }
+
+    // the end of the last complete row returned by next_rows()
+    auto offset() const
+    {
+        return offset_;
+    }
+
+    auto header() const
+    {
+        return row{ header_.data(), header_.data() + header_.size() };
+    }
+
+    auto index_of(std::string_view column_name) const
+    {
+        int index = 0;
+        for (const auto cell : header())
+        {
+            if (column_name == cell.trimed())
+                return index;
+            index++;
+        }
+        throw error{ "Column does not exist" };
+    }
+
+  private:
+    // end of the last complete row in [begin, dead_end), or of the first one when `first_only` is set, `begin` when there is none
+    static const char* complete_rows_end(const char* begin, const char* dead_end, bool first_only)
+    {
+        if constexpr (multiline_cells::value)
+        {
+            const auto* end = begin;
+            std::uint64_t inside = 0;
+            for (const auto* i = begin; i < dead_end;)
+            {
+                const auto* new_line = detail::simd::find_unquoted(i, dead_end, quote_char::value, '\n', inside);
+                if (new_line == dead_end)
+                    break;
+                end = i = new_line + 1;
+                inside = 0;
+                if (first_only)
+                    break;
+            }
+            return end;
+        }
+        else
+        {
+            if (first_only)
+            {
+                const auto* new_line = static_cast<const char*>(memchr(begin, '\n', dead_end - begin));
+                return new_line ? new_line + 1 : begin;
+            }
+            const auto last_new_line = std::find(std::make_reverse_iterator(dead_end), std::make_reverse_iterator(begin), '\n');
+            return last_new_line.base();
+        }
+    }
+};
+
+// parses a set of files with the same header as one, e.g. the part files of an export, a file is mapped on first use and
+// its header is checked against the first file, rows are iterated in file order or split into work units for a thread pool
+template<
+    class has_header = has_header<true>,
+    class delimiter = delimiter<','>,
+    class quote_char = quote_char<'"'>,
+    class trim_policy = trim_chars<' ', '\t'>,
+    class multiline_cells = multiline_cells<false>>
+class multi_parser
+{
+    using file_parser = parser<mmap_source, has_header, delimiter, quote_char, trim_policy, multiline_cells>;
+
+  public:
+    using cell = typename file_parser::cell;
+    using row = typename file_parser::row;
+    using tokenized_row = typename file_parser::tokenized_row;
+    using shard = typename file_parser::shard;
+
+    // a part of a file of about `unit_size` bytes, rows() returns its rows
+    struct work_unit
+    {
+        std::size_t file;
+        std::size_t part;
+    };
+
+  private:
+    struct mapped_file
+    {
+        file_parser csv;
+        std::vector<shard> shards;
+
+        mapped_file(const std::string& path, const mmap_options& options, std::size_t parts)
+            : csv(path, options)
+            , shards(csv.shards(parts))
+        {
+        }
+    };
+
+    std::vector<std::string> paths_;
+    std::vector<std::size_t> sizes_;
+    std::vector<std::size_t> parts_;
+    mmap_options options_;
+    mutable std::vector<std::unique_ptr<mapped_file>> files_;
+    mutable std::unique_ptr<std::once_flag[]> mapped_;
+
+  public:
+    explicit multi_parser(std::vector<std::string> paths, std::size_t unit_size = 64 << 20, const mmap_options& options = {})
+        : paths_(std::move(paths))
+        , options_(options)
+        , files_(paths_.size())
+        , mapped_(std::make_unique<std::once_flag[]>(paths_.size()))
+    {
+        if (paths_.empty())
+            throw error{ "No files to parse" };
+
+        for (const auto& path : paths_)
+        {
+            struct stat status;
+            if (stat(path.c_str(), &status) == -1)
+                throw error{ "can't stat file, path: " + path + ", error:" + std::string{ std::strerror(errno) } };
+            const auto size = static_cast<std::size_t>(status.st_size);
+            sizes_.push_back(size);
+            parts_.push_back(std::max<std::size_t>((size + unit_size - 1) / std::max<std::size_t>(unit_size, 1), 1));
+        }
+        file(0); // the header of the first file is the reference
+    }
+
+    class row_iterator
+    {
+        const multi_parser* owner_;
+        std::size_t file_;
+        typename file_parser::row_iterator current_{ "", "" };
+        typename file_parser::row_iterator end_{ "", "" };
+
+      public:
+        using value_type = row;
+        using difference_type = std::ptrdiff_t;
+        using iterator_category = std::input_iterator_tag;
+        using pointer = row;
+        using reference = row;
+
+        row_iterator(const multi_parser* owner, std::size_t file)
+            : owner_(owner)
+            , file_(file)
+        {
+            open();
+        }
+
+        auto& operator++()
+        {
+            if (++current_ == end_)
+            {
+                file_++;
+                open();
+            }
+            return *this;
+        }
+
+        bool operator!=(const row_iterator& rhs) const
+        {
+            return !(*this == rhs);
+        }
+
+        bool operator==(const row_iterator& rhs) const
+        {
+            return file_ == rhs.file_ && (file_ == owner_->file_count() || current_ == rhs.current_);
+        }
+
+        auto operator*() const
+        {
+            return *current_;
+        }
+
+        auto operator->() const
+        {
+            return *current_;
+        }
+
+        // index of the file of the current row
+        auto file() const
+        {
+            return file_;
+        }
+
+      private:
+        // moves to the first row of the first file from `file_` which is not empty
+        void open()
+        {
+            for (; file_ < owner_->file_count(); file_++)
+            {
+                const auto& csv = owner_->file(file_);
+                current_ = csv.begin();
+                end_ = csv.end();
+                if (current_ != end_)
+                    return;
+            }
+        }
+    };
+
+    auto begin() const
+    {
+        return row_iterator{ this, 0 };
+    }
+
+    auto end() const
+    {
+        return row_iterator{ this, file_count() };
+    }
+
+    // work units of all files, the largest units come first so a thread pool taking them in order stays balanced
+    auto work_units() const
+    {
+        std::vector<work_unit> units;
+        for (std::size_t file = 0; file < paths_.size(); file++)
+        {
+            for (std::size_t part = 0; part < parts_[file]; part++)
+                units.push_back({ file, part });
+        }
+        std::stable_sort(units.begin(),
+                         units.end(),
+                         [this](const work_unit& lhs, const work_unit& rhs)
+                         { return sizes_[lhs.file] / parts_[lhs.file] > sizes_[rhs.file] / parts_[rhs.file]; });
+        return units;
+    }
+
+    // maps the file of the unit on first use, can be called concurrently
+    shard rows(const work_unit& unit) const
+    {
+        const auto& shards = mapped(unit.file).shards;
+        if (unit.part < shards.size())
+            return shards[unit.part];
+        return shard{ "", "" }; // rows were too long to split the file in as many parts
+    }
+
+    auto header() const
+    {
+        return file(0).header();
+    }
+
+    auto index_of(std::string_view column_name) const
+    {
+        return file(0).index_of(column_name);
+    }
+
+    template<typename... Names>
+    auto indexes_of(Names... column_names) const
+    {
+        return file(0).indexes_of(column_names...);
+    }
+
+    auto file_count() const
+    {
+        return paths_.size();
+    }
+
+    const auto& path(std::size_t file) const
+    {
+        return paths_[file];
+    }
+
+    // maps the file on first use, can be called concurrently
+    const file_parser& file(std::size_t index) const
+    {
+        return mapped(index).csv;
+    }
+
+  private:
+    const mapped_file& mapped(std::size_t index) const
+    {
+        std::call_once(mapped_[index],
+                       [&]
+                       {
+                           auto opened = std::make_unique<mapped_file>(paths_[index], options_, parts_[index]);
+                           if constexpr (has_header::value)
+                           {
+                               if (index != 0 && opened->csv.header().raw() != file(0).header().raw())
+                                   throw error{ "Header doesn't match the first file, path: " + paths_[index] };
+                           }
+                           files_[index] = std::move(opened);
+                       });
+        return *files_[index];
+    }
+};
+
+// buffers csv output for a sink, any callable with write(2) semantics that writes the whole buffer or throws
+// fields containing the delimiter, the quote or a new line are quoted, and their quotes are doubled
+template<class sink = fd_writer, class delimiter = delimiter<','>, class quote_char = quote_char<'"'>>
+class writer
+{
+    sink sink_;
+    std::unique_ptr<char[]> buffer_;
+    std::size_t capacity_;
+    std::size_t size_{ 0 };
+    bool row_started_{ false };
+
+  public:
+    explicit writer(sink output, std::size_t capacity = 1 << 20)
+        : sink_(std::move(output))
+        , buffer_(std::make_unique<char[]>(capacity))
+        , capacity_(capacity)
+    {
+        if (capacity_ == 0)
+            throw error{ "Writer capacity must not be zero" };
+    }
+
+    writer(const writer&) = delete;
+    writer& operator=(const writer&) = delete;
+
+    writer(writer&& other) noexcept
+        : sink_(std::move(other.sink_))
+        , buffer_(std::move(other.buffer_))
+        , capacity_(other.capacity_)
+        , size_(std::exchange(other.size_, 0))
+        , row_started_(other.row_started_)
+    {
+    }
+
+    writer& operator=(writer&&) = delete;
+
+    // fields are string like types, characters or numbers, numbers are formatted with to_chars
+    template<class... Fields>
+    void write_row(const Fields&... fields)
+    {
+        (write_cell(fields), ...);
+        end_row();
+    }
+
+    template<class Field>
+    void write_cell(const Field& field)
+    {
+        if (row_started_)
+            append(delimiter::value);
+        row_started_ = true;
+
+        if constexpr (std::is_arithmetic_v<Field> && !std::is_same_v<Field, char>)
+        {
+            static_assert(!std::is_same_v<Field, bool>, "bool fields must be written as strings or numbers");
+            char digits[64];
+            const auto* digits_end = detail::to_chars(digits, digits + sizeof(digits), field);
+            if (!digits_end)
+                throw error{ "Number doesn't fit in the buffer" };
+            append(digits, static_cast<std::size_t>(digits_end - digits));
+        }
+        else
+        {
+            const auto text = [&field]
+            {
+                if constexpr (std::is_same_v<Field, char>)
+                    return std::string_view{ &field, 1 };
+                else
+                    return std::string_view{ field };
+            }();
+            if (text.empty())
+                return;
+            const auto* begin = text.data();
+            const auto* end = begin + text.size();
+            if (!detail::simd::needs_quoting(begin, end, quote_char::value, delimiter::value))
+                return append(begin, text.size());
+
+            append(quote_char::value);
+            for (const char* quote; (quote = static_cast<const char*>(memchr(begin, quote_char::value, end - begin))); begin = quote + 1)
+            {
+                append(begin, static_cast<std::size_t>(quote + 1 - begin));
+                append(quote_char::value);
+            }
+            append(begin, static_cast<std::size_t>(end - begin));
+            append(quote_char::value);
+        }
+    }
+
+    void end_row()
+    {
+        append('\n');
+        row_started_ = false;
+    }
+
+    void flush()
+    {
+        if (size_)
+        {
+            sink_(buffer_.get(), size_);
+            size_ = 0;
+        }
+    }
+
+    // flushes the buffer and closes an fd_writer sink, errors are thrown, unlike on destruction
+    void close()
+    {
+        flush();
+        if constexpr (std::is_same_v<sink, fd_writer>)
+            sink_.close();
+    }
+
+    sink& data_sink()
+    {
+        return sink_;
+    }
+
+    // flushes the remaining rows but swallows errors, call close() or flush() before to have them reported
+    ~writer()
+    {
+        try
+        {
+            flush();
+        }
+        catch (...)
+        {
+        }
+    }
+
+  private:
+    void append(char c)
+    {
+        if (size_ == capacity_)
+            flush();
+        buffer_[size_++] = c;
+    }
+
+    void append(const char* data, std::size_t size)
+    {
+        while (size > capacity_ - size_)
+        {
+            const auto chunk = capacity_ - size_;
+            std::memcpy(buffer_.get() + size_, data, chunk);
+            size_ = capacity_;
+            flush();
+            data += chunk;
+            size -= chunk;
+        }
+        std::memcpy(buffer_.get() + size_, data, size);
+        size_ += size;
+    }
+};
+
+// a dialect chosen at run time, dialect_parser::visit() selects the parser instantiated for it
+struct dialect
+{
+    char delimiter{ ',' };
+    char quote_char{ '"' };
+    bool has_header{ true };
+    bool multiline_cells{ false };
+};
+
+namespace detail
+{
+template<char first, char... rest, class function>
+auto dispatch_char(char value, function&& visitor)
+{
+    if (value == first)
+        return visitor(std::integral_constant<char, first>{});
+    if constexpr (sizeof...(rest) != 0)
+        return dispatch_char<rest...>(value, std::forward<function>(visitor));
+    else
+        throw error{ "Dialect character is not supported" };
+}
+
+template<class function>
+auto dispatch_bool(bool value, function&& visitor)
+{
+    if (value)
+        return visitor(std::true_type{});
+    return visitor(std::false_type{});
+}
+
+// calls `visit(row, column, cell)` for every cell of the sample, quotes are not removed
+template<class function>
+void split_sample(std::string_view sample, char delimiter, char quote, function&& visit)
+{
+    std::size_t row = 0;
+    std::size_t column = 0;
+    std::size_t cell_begin = 0;
+    bool inside = false;
+    for (std::size_t i = 0; i < sample.size(); i++)
+    {
+        if (sample[i] == quote)
+            inside = !inside;
+        else if (!inside && (sample[i] == delimiter || sample[i] == '\n'))
+        {
+            visit(row, column++, sample.substr(cell_begin, i - cell_begin));
+            cell_begin = i + 1;
+            if (sample[i] == '\n')
+            {
+                row++;
+                column = 0;
+            }
+        }
+    }
+    if (cell_begin < sample.size())
+        visit(row, column, sample.substr(cell_begin));
+}
+
+inline bool looks_numeric(std::string_view cell, char quote)
+{
+    const auto first = cell.find_first_not_of(std::string{ ' ', '\t', '\r', quote });
+    if (first == std::string_view::npos)
+        return false;
+    cell = cell.substr(first, cell.find_last_not_of(std::string{ ' ', '\t', '\r', quote }) + 1 - first);
+    double value = 0;
+    return from_chars(cell.data(), cell.data() + cell.size(), value) == std::errc{};
+}
+} // namespace detail
+
+// detects the dialect from a sample of the first rows, an incomplete last row is ignored
+inline dialect sniff(std::string_view sample)
+{
+    if (const auto last_new_line = sample.rfind('\n'); last_new_line != std::string_view::npos)
+        sample = sample.substr(0, last_new_line + 1);
+    dialect result;
+
+    // single quotes are only picked when they open cells and no double quote exists
+    std::size_t opening_single_quotes = 0;
+    for (std::size_t i = 0; i < sample.size() && sample[i] != '"'; i++)
+    {
+        if (sample[i] == '\'' && (i == 0 || std::strchr(",;\t|\n", sample[i - 1])))
+            opening_single_quotes++;
+    }
+    if (opening_single_quotes && sample.find('"') == std::string_view::npos)
+        result.quote_char = '\'';
+
+    bool inside = false;
+    for (const auto character : sample)
+    {
+        if (character == result.quote_char)
+            inside = !inside;
+        else if (character == '\n' && inside)
+            result.multiline_cells = true;
+    }
+
+    // the delimiter which gives the most consistent cell count per row wins, ties go to more cells
+    double best_consistency = 0;
+    std::size_t best_cells = 1;
+    for (const auto candidate : { ',', ';', '\t', '|' })
+    {
+        std::vector<std::size_t> cells_per_row;
+        detail::split_sample(sample,
+                             candidate,
+                             result.quote_char,
+                             [&](std::size_t row, std::size_t column, std::string_view)
+                             {
+                                 cells_per_row.resize(row + 1);
+                                 cells_per_row[row] = column + 1;
+                             });
+        if (cells_per_row.empty())
+            continue;
+
+        std::sort(cells_per_row.begin(), cells_per_row.end());
+        std::size_t modal_cells = 0;
+        std::size_t modal_rows = 0;
+        for (auto i = cells_per_row.begin(); i != cells_per_row.end();)
+        {
+            const auto next = std::upper_bound(i, cells_per_row.end(), *i);
+            if (next - i >= static_cast<std::ptrdiff_t>(modal_rows))
+            {
+                modal_cells = *i;
+                modal_rows = next - i;
+            }
+            i = next;
+        }
+
+        const auto consistency = static_cast<double>(modal_rows) / cells_per_row.size();
+        if (modal_cells > 1 && (consistency > best_consistency || (consistency == best_consistency && modal_cells > best_cells)))
+        {
+            result.delimiter = candidate;
+            best_consistency = consistency;
+            best_cells = modal_cells;
+        }
+    }
+
+    // column names are never numbers
+    detail::split_sample(sample,
+                         result.delimiter,
+                         result.quote_char,
+                         [&](std::size_t row, std::size_t, std::string_view cell)
+                         {
+                             if (row == 0 && detail::looks_numeric(cell, result.quote_char))
+                                 result.has_header = false;
+                         });
+    return result;
+}
+
+// a parser for dialects known at run time, visit() calls a function with the parser instantiated for the dialect
+template<class source = mmap_source>
+class dialect_parser
+{
+    source source_;
+    lazycsv::dialect dialect_;
+
+  public:
+    static constexpr std::size_t sample_size = 16 * 1024;
+
+    // the dialect is sniffed from the first `sample_size` bytes
+    template<typename... Args>
+    explicit dialect_parser(Args&&... args)
+        : source_(std::forward<Args>(args)...)
+        , dialect_(sniff(std::string_view(source_.data(), std::min(source_.size(), sample_size))))
+    {
+    }
+
+    const auto& dialect() const
+    {
+        return dialect_;
+    }
+
+    void set_dialect(const lazycsv::dialect& dialect)
+    {
+        dialect_ = dialect;
+    }
+
+    const auto& data_source() const
+    {
+        return source_;
+    }
+
+    // delimiters are one of `,;\t|` and quotes one of `"'`, other characters throw
+    template<class function>
+    auto visit(function&& visitor) const
+    {
+        const std::string_view data(source_.data(), source_.size());
+        return detail::dispatch_char<',', ';', '\t', '|'>(
+            dialect_.delimiter,
+            [&](auto delimiter_value)
+            {
+                return detail::dispatch_char<'"', '\''>(
+                    dialect_.quote_char,
+                    [&](auto quote_value)
+                    {
+                        return detail::dispatch_bool(
+                            dialect_.has_header,
+                            [&](auto header_value)
+                            {
+                                return detail::dispatch_bool(
+                                    dialect_.multiline_cells,
+                                    [&](auto multiline_value)
+                                    {
+                                        const parser<std::string_view,
+                                                     has_header<decltype(header_value)::value>,
+                                                     delimiter<decltype(delimiter_value)::value>,
+                                                     quote_char<decltype(quote_value)::value>,
+                                                     trim_chars<' ', '\t'>,
+                                                     multiline_cells<decltype(multiline_value)::value>>
+                                            specialized{ data };
+                                        return visitor(specialized);
+                                    });
+                            });
+                    });
+            });
+    }
 };
-} // namespace lazycsv
\ No newline at end of file
+} // namespace lazycsv
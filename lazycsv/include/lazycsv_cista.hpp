@@ -0,0 +1,193 @@
+#pragma once
+
+// csv to cista snapshots, rows are decoded by parallel shards and serialized once so later loads are a single
+// deserialization over a memory mapped file, and parallel aggregations into cista hash maps
+// this header needs cista in the include path
+
+#include <lazycsv.hpp>
+
+#include <cista/containers/hash_map.h>
+#include <cista/mmap.h>
+#include <cista/serialization.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <list>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace lazycsv
+{
+// cista mode of snapshots, the type hash rejects snapshots written for another struct layout
+constexpr auto snapshot_mode = cista::mode::WITH_VERSION;
+
+// decodes the rows of `csv` with one thread per shard into a cista vector, the row order is kept
+template<class parser, class binding>
+auto to_cista(const parser& csv, const binding& decoder, std::size_t threads = std::thread::hardware_concurrency())
+{
+    using value_type = typename binding::value_type;
+    const auto shards = csv.shards(std::max<std::size_t>(threads, 1));
+    std::vector<std::vector<value_type>> decoded(shards.size());
+    std::vector<std::exception_ptr> errors(shards.size());
+    std::vector<std::thread> workers;
+    for (std::size_t i = 0; i < shards.size(); i++)
+    {
+        workers.emplace_back(
+            [&, i]
+            {
+                try
+                {
+                    for (const auto row : shards[i])
+                        decoded[i].push_back(decoder.decode(row));
+                }
+                catch (...)
+                {
+                    errors[i] = std::current_exception();
+                }
+            });
+    }
+    for (auto& worker : workers)
+        worker.join();
+    for (const auto& error : errors)
+    {
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    std::size_t size = 0;
+    for (const auto& rows : decoded)
+        size += rows.size();
+    cista::offset::vector<value_type> result;
+    result.reserve(size);
+    for (auto& rows : decoded)
+    {
+        for (auto& row : rows)
+            result.push_back(std::move(row));
+    }
+    return result;
+}
+
+template<class T, cista::mode mode = snapshot_mode>
+void save_snapshot(const std::string& path, const cista::offset::vector<T>& rows)
+{
+    cista::buf<cista::mmap> output{ cista::mmap{ path.c_str() } };
+    cista::serialize<mode>(output, rows);
+}
+
+// a read only mapping of a snapshot, the rows refer to the mapping and live as long as the snapshot
+template<class T, cista::mode mode = snapshot_mode>
+class snapshot
+{
+    cista::mmap file_;
+    const cista::offset::vector<T>* rows_;
+
+  public:
+    explicit snapshot(const std::string& path)
+        : file_(path.c_str(), cista::mmap::protection::READ)
+        , rows_(cista::deserialize<cista::offset::vector<T>, mode>(file_.data(), file_.data() + file_.size()))
+    {
+    }
+
+    const auto& rows() const
+    {
+        return *rows_;
+    }
+};
+
+// the sum and the number of rows of a group
+template<class T>
+struct aggregate
+{
+    T sum{};
+    std::size_t count{ 0 };
+};
+
+// keys refer to the parsed data, except keys with escaped quotes which are unescaped into `escaped_keys`
+template<class T>
+struct grouped
+{
+    cista::raw::hash_map<std::string_view, aggregate<T>> groups;
+    std::list<std::string> escaped_keys;
+};
+
+// sums `value_column` grouped by the unescaped cells of `key_column`, each shard aggregates into its own hash table and
+// the tables are merged at the end, keys are valid as long as the parser and the result are alive
+template<class T = double, class parser>
+grouped<T> group_by(const parser& csv,
+                    std::string_view key_column,
+                    std::string_view value_column,
+                    std::size_t threads = std::thread::hardware_concurrency())
+{
+    const auto key_index = csv.index_of(key_column);
+    const auto value_index = csv.index_of(value_column);
+    if (key_index == value_index)
+        throw error{ "Key and value columns must differ" };
+
+    const auto shards = csv.shards(std::max<std::size_t>(threads, 1));
+    std::vector<grouped<T>> partials(shards.size());
+    std::vector<std::exception_ptr> errors(shards.size());
+    std::vector<std::thread> workers;
+    for (std::size_t i = 0; i < shards.size(); i++)
+    {
+        workers.emplace_back(
+            [&, i]
+            {
+                try
+                {
+                    auto& [groups, escaped_keys] = partials[i];
+                    for (const auto row : shards[i])
+                    {
+                        const auto [first, second] = row.cells(std::min(key_index, value_index), std::max(key_index, value_index));
+                        const auto& key_cell = key_index < value_index ? first : second;
+                        const auto& value_cell = key_index < value_index ? second : first;
+                        const auto value = value_cell.template as<T>();
+                        if (!value)
+                            throw error{ "Cell is not a valid number" };
+
+                        const auto key = key_cell.unescaped();
+                        auto group = groups.find(key.view());
+                        if (group == groups.end())
+                        {
+                            const std::string_view stored = key.copied() ? escaped_keys.emplace_back(key.view()) : key.view();
+                            group = groups.emplace(stored, aggregate<T>{}).first;
+                        }
+                        group->second.sum += value.value;
+                        group->second.count++;
+                    }
+                }
+                catch (...)
+                {
+                    errors[i] = std::current_exception();
+                }
+            });
+    }
+    for (auto& worker : workers)
+        worker.join();
+    for (const auto& error : errors)
+    {
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    grouped<T> result;
+    for (auto& partial : partials)
+    {
+        if (result.groups.size() == 0)
+            result.groups = std::move(partial.groups);
+        else
+        {
+            for (const auto& entry : partial.groups)
+            {
+                auto& merged = result.groups[entry.first];
+                merged.sum += entry.second.sum;
+                merged.count += entry.second.count;
+            }
+        }
+        result.escaped_keys.splice(result.escaped_keys.end(), partial.escaped_keys);
+    }
+    return result;
+}
+} // namespace lazycsv
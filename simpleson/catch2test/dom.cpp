@@ -0,0 +1,96 @@
+#include "json.h"
+#include <catch2/catch_test_macros.hpp>
+
+static const char *dom_input = "{\"name\": \"hello \\\"world\\\"\", \"count\": 42, \"ratio\": -1.5e2, \"flags\": [true, false, null],"
+	" \"nested\": {\"inner\": [{\"id\": 7}, \"text\"]}, \"empty\": {}}";
+
+TEST_CASE("JsonNode scalars", "[json][node]") {
+	json::node doc = json::node::parse(dom_input);
+	REQUIRE(doc.is_object());
+	REQUIRE_FALSE(doc.is_array());
+	REQUIRE(doc.size() == 6);
+	REQUIRE(doc.has_key("nested"));
+	REQUIRE_FALSE(doc.has_key("missing"));
+	REQUIRE(doc.key(1) == "count");
+	REQUIRE(doc["name"].is_string());
+	REQUIRE(doc["name"].as_string() == "hello \"world\"");
+	REQUIRE(doc["count"].is_number());
+	REQUIRE((int)doc["count"] == 42);
+	REQUIRE((double)doc["ratio"] == -150.0);
+	REQUIRE(doc["flags"][0].is_true());
+	REQUIRE(doc["flags"][1].is_bool());
+	REQUIRE_FALSE(doc["flags"][1].is_true());
+	REQUIRE(doc["flags"][2].is_null());
+}
+
+TEST_CASE("JsonNode nested access", "[json][node]") {
+	json::node doc = json::node::parse(dom_input);
+	REQUIRE((int)doc["nested"]["inner"][0]["id"] == 7);
+	REQUIRE(doc["nested"]["inner"][1].as_string() == "text");
+	REQUIRE(doc["empty"].size() == 0);
+}
+
+TEST_CASE("JsonNode serialization", "[json][node]") {
+	json::node doc = json::node::parse(dom_input);
+	json::jobject obj = json::jobject::parse(dom_input);
+	REQUIRE(doc["nested"].serialize() == "{\"inner\":[{\"id\":7},\"text\"]}");
+	REQUIRE(doc.serialize() == obj.as_string());
+	REQUIRE(json::node(obj).serialize() == obj.as_string());
+	REQUIRE(doc.as_object().as_string() == obj.as_string());
+	REQUIRE(doc.pretty() == obj.pretty());
+}
+
+TEST_CASE("JsonNode typed scalars", "[json][node]") {
+	// Numbers are converted and strings decoded once, the JSON text of numbers and escaped strings is kept
+	const char *typed_input = "[4294967295,-2147483648,2.75,-7,\"a\\/b\\tc\\u0041\",\"plain\",true,null]";
+	json::node typed = json::node::parse(typed_input);
+	REQUIRE((unsigned int)typed[0] == 4294967295u);
+	REQUIRE((long)typed[1] == -2147483648L);
+	REQUIRE((int)typed[2] == 2);
+	REQUIRE((double)typed[2] == 2.75);
+	REQUIRE((float)typed[2] == 2.75f);
+	REQUIRE((int)typed[3] == -7);
+	REQUIRE((float)typed[3] == -7.0f);
+	REQUIRE(typed[4].as_string().substr(0, 5) == std::string("a/b\tc"));
+	REQUIRE(typed[4].serialize() == std::string("\"a\\/b\\tc\\u0041\""));
+	REQUIRE(typed[5].serialize() == std::string("\"plain\""));
+	REQUIRE(typed[6].serialize() == std::string("true"));
+	REQUIRE(typed[7].serialize() == std::string("null"));
+	REQUIRE(typed.serialize() == std::string(typed_input));
+}
+
+TEST_CASE("JsonNode escaped keys", "[json][node]") {
+	// Keys are stored decoded and must be encoded again when printed
+	json::node escaped = json::node::parse("{\"k\\\"q\":{\"x\\\\y\\n\":1,\"plain\":[true]}}");
+	REQUIRE(escaped.key(0) == "k\"q");
+	REQUIRE(json::node::parse(escaped.pretty()).serialize() == escaped.serialize());
+}
+
+TEST_CASE("JsonNode errors", "[json][node]") {
+	json::node doc = json::node::parse(dom_input);
+	REQUIRE_THROWS_AS(doc["missing"], json::invalid_key);
+	REQUIRE_THROWS_AS(doc["count"]["missing"], json::invalid_key);
+	REQUIRE_THROWS_AS(json::node::parse("{\"a\" 1}"), json::parsing_error);
+	REQUIRE_THROWS_AS(json::node::parse("[1,]"), json::parsing_error);
+	REQUIRE_THROWS_AS(json::node::parse("[\"open"), json::parsing_error);
+	REQUIRE_THROWS_AS(json::node::parse("[01]"), json::parsing_error);
+	REQUIRE_THROWS_AS(json::node::parse("[tru]"), json::parsing_error);
+	REQUIRE_THROWS_AS(json::node::parse("  "), json::parsing_error);
+}
+
+#ifdef JSON_USE_PMR
+TEST_CASE("JsonNode memory resource", "[json][node]") {
+	// The whole document must fit in the buffer since the upstream resource refuses to allocate
+	char buffer[1 << 16];
+	std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+	json::node doc = json::node::parse(dom_input, &arena);
+	REQUIRE(doc.get_allocator().resource() == &arena);
+	REQUIRE(doc["nested"]["inner"][0].get_allocator().resource() == &arena);
+	REQUIRE(doc.serialize() == json::node::parse(dom_input).serialize());
+	REQUIRE(doc.key(4) == "nested");
+	REQUIRE((int)doc["nested"]["inner"][0]["id"] == 7);
+	json::node copy = doc["nested"];
+	REQUIRE(copy.get_allocator().resource() == std::pmr::get_default_resource());
+	REQUIRE(copy.serialize() == "{\"inner\":[{\"id\":7},\"text\"]}");
+}
+#endif
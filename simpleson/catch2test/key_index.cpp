@@ -0,0 +1,65 @@
+#include "json.h"
+#include <catch2/catch_test_macros.hpp>
+#include <cstdio>
+
+static json::jobject make_large_object(const int count)
+{
+	char key[32];
+	json::jobject result;
+	for (int i = 0; i < count; i++)
+	{
+		snprintf(key, sizeof(key), "key%d", i);
+		result[key] = i;
+	}
+	return result;
+}
+
+TEST_CASE("JsonKeyIndex Lookup", "[json][key_index]") {
+	json::jobject test = make_large_object(1000);
+	char key[32];
+	REQUIRE(test.size() == 1000);
+	for (int i = 0; i < 1000; i++)
+	{
+		snprintf(key, sizeof(key), "key%d", i);
+		REQUIRE(test.has_key(key));
+		REQUIRE((int)test[key] == i);
+	}
+	REQUIRE_FALSE(test.has_key("missing"));
+	REQUIRE_THROWS_AS(test.get("missing"), json::invalid_key);
+}
+
+TEST_CASE("JsonKeyIndex Modification", "[json][key_index]") {
+	json::jobject test = make_large_object(1000);
+	test["key10"] = "updated";
+	REQUIRE(test.size() == 1000);
+	REQUIRE(test.list_keys().at(10) == "key10");
+	REQUIRE(test["key10"].as_string() == "updated");
+
+	test.remove("key0");
+	test.remove(499);
+	REQUIRE(test.size() == 998);
+	REQUIRE_FALSE(test.has_key("key0"));
+	REQUIRE_FALSE(test.has_key("key500"));
+	REQUIRE((int)test["key999"] == 999);
+	REQUIRE(test.list_keys().front() == "key1");
+
+	json::kvp entry("appended", "1");
+	test += entry;
+	REQUIRE((int)test["appended"] == 1);
+	REQUIRE(test.list_keys().back() == "appended");
+	REQUIRE_THROWS_AS(test += entry, json::parsing_error);
+}
+
+TEST_CASE("JsonKeyIndex CopyAndParse", "[json][key_index]") {
+	json::jobject test = make_large_object(1000);
+	json::jobject parsed = json::jobject::parse(test.as_string());
+	REQUIRE(parsed.as_string() == test.as_string());
+	REQUIRE((int)parsed["key998"] == 998);
+	json::jobject assigned;
+	assigned = parsed;
+	REQUIRE((int)assigned["key1"] == 1);
+	assigned.clear();
+	REQUIRE_FALSE(assigned.has_key("key1"));
+	assigned["key1"] = 2;
+	REQUIRE((int)assigned["key1"] == 2);
+}
@@ -0,0 +1,48 @@
+#include "json.h"
+#include <catch2/catch_test_macros.hpp>
+#include <limits.h>
+
+TEST_CASE("JsonNumber RoundTrip", "[json][number]") {
+	json::jobject test;
+	test["int_min"] = INT_MIN;
+	test["int_max"] = INT_MAX;
+	test["uint_max"] = UINT_MAX;
+	test["long_min"] = LONG_MIN;
+	test["ulong_max"] = ULONG_MAX;
+	test["double"] = 123.456;
+	test["small"] = -1.5e-300;
+	test["float"] = 0.1f;
+
+	json::jobject retest = json::jobject::parse(test.as_string());
+	json::key_list_t keys = retest.list_keys();
+	for (size_t i = 0; i < keys.size(); i++) REQUIRE(retest[keys[i]].is_number());
+
+	REQUIRE((int)retest["int_min"] == INT_MIN);
+	REQUIRE((int)retest["int_max"] == INT_MAX);
+	REQUIRE((unsigned int)retest["uint_max"] == UINT_MAX);
+	REQUIRE((long)retest["long_min"] == LONG_MIN);
+	REQUIRE((unsigned long)retest["ulong_max"] == ULONG_MAX);
+	REQUIRE((double)retest["double"] == 123.456);
+	REQUIRE((double)retest["small"] == -1.5e-300);
+	REQUIRE((float)retest["float"] == 0.1f);
+	REQUIRE(retest.get("int_min") == "-2147483648");
+}
+
+TEST_CASE("JsonNumber Arrays", "[json][number]") {
+	json::jobject test;
+	std::vector<double> doubles;
+	doubles.push_back(0.5);
+	doubles.push_back(-2.25);
+	doubles.push_back(1e10);
+	test["doubles"] = doubles;
+	std::vector<double> doubles_out = test["doubles"];
+	REQUIRE(doubles_out.size() == 3);
+	REQUIRE(doubles_out[0] == 0.5);
+	REQUIRE(doubles_out[1] == -2.25);
+	REQUIRE(doubles_out[2] == 1e10);
+}
+
+TEST_CASE("JsonNumber Truncation", "[json][number]") {
+	REQUIRE((int)json::jobject::parse("{\"value\":12.75}")["value"] == 12);
+	REQUIRE((double)json::jobject::parse("{\"value\":2.5e3}")["value"] == 2500.0);
+}
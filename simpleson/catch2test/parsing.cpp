@@ -59,3 +59,28 @@ TEST_CASE("JsonReader parses numbers", "[json][reader]") {
         REQUIRE(stream.readout() == std::string(data_point));
     }
 }
+
+static const char *spaced_input =
+    " {\n\t\"a long key with \\\"escapes\\\" and \\/ more\" :\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t[ 1 , \"x\" ]\r\n} tail";
+static const char *spaced_output = "{\"a long key with \\\"escapes\\\" and \\/ more\":[1,\"x\"]}";
+
+TEST_CASE("JsonParsing bulk parse matches the reader", "[json][parsing]") {
+    for(size_t i = 0; i < sizeof(test_data) / sizeof(test_struct_t); i++) {
+        const json::parsing::parse_results result = json::parsing::parse(test_data[i].input);
+        REQUIRE(result.type == test_data[i].type);
+        REQUIRE(std::string(result.value.c_str()) == std::string(test_data[i].output));
+        REQUIRE(*result.remainder == '\0');
+    }
+    for(size_t i = 0; i < sizeof(test_numbers) / sizeof(char*); i++) {
+        const json::parsing::parse_results result = json::parsing::parse(test_numbers[i]);
+        REQUIRE(result.type == json::jtype::jnumber);
+        REQUIRE(std::string(result.value.c_str()) == std::string(test_numbers[i]));
+    }
+    const json::parsing::parse_results spaced = json::parsing::parse(spaced_input);
+    REQUIRE(spaced.type == json::jtype::jobject);
+    REQUIRE(std::string(spaced.value.c_str()) == std::string(spaced_output));
+    REQUIRE(std::string(spaced.remainder) == std::string(" tail"));
+    REQUIRE(json::parsing::parse("[1,]").type == json::jtype::not_valid);
+    REQUIRE(json::parsing::parse("[\"open").type == json::jtype::not_valid);
+    REQUIRE(json::parsing::parse("\"bad \\q\"").type == json::jtype::not_valid);
+}
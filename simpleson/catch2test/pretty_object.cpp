@@ -65,3 +65,10 @@ TEST_CASE("JsonPrettyPrint parse and format object", "[json][pretty]") {
     json::jobject copy(result);
     REQUIRE(copy.as_string() == result.as_string());
 }
+
+TEST_CASE("JsonPrettyPrint invalid value", "[json][pretty]") {
+    // Values which are not valid JSON are printed as they are stored
+    json::jobject invalid;
+    invalid["x"] = nan("");
+    REQUIRE(invalid.pretty() == std::string("{\n\t\"x\": nan\n}"));
+}
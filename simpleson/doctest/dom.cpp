@@ -0,0 +1,103 @@
+#include "json.h"
+#include <doctest/doctest.h>
+
+static const char *dom_input = "{\"name\": \"hello \\\"world\\\"\", \"count\": 42, \"ratio\": -1.5e2, \"flags\": [true, false, null],"
+	" \"nested\": {\"inner\": [{\"id\": 7}, \"text\"]}, \"empty\": {}}";
+
+TEST_CASE("JsonNodeTest - Scalars")
+{
+	json::node doc = json::node::parse(dom_input);
+	CHECK(doc.is_object());
+	CHECK_FALSE(doc.is_array());
+	CHECK_EQ(doc.size(), 6);
+	CHECK(doc.has_key("nested"));
+	CHECK_FALSE(doc.has_key("missing"));
+	CHECK_EQ(doc.key(1), "count");
+	CHECK(doc["name"].is_string());
+	CHECK_EQ(doc["name"].as_string(), "hello \"world\"");
+	CHECK(doc["count"].is_number());
+	CHECK_EQ((int)doc["count"], 42);
+	CHECK_EQ((double)doc["ratio"], -150.0);
+	CHECK(doc["flags"][0].is_true());
+	CHECK(doc["flags"][1].is_bool());
+	CHECK_FALSE(doc["flags"][1].is_true());
+	CHECK(doc["flags"][2].is_null());
+}
+
+TEST_CASE("JsonNodeTest - NestedAccess")
+{
+	json::node doc = json::node::parse(dom_input);
+	CHECK_EQ((int)doc["nested"]["inner"][0]["id"], 7);
+	CHECK_EQ(doc["nested"]["inner"][1].as_string(), "text");
+	CHECK_EQ(doc["empty"].size(), 0);
+}
+
+TEST_CASE("JsonNodeTest - Serialization")
+{
+	json::node doc = json::node::parse(dom_input);
+	json::jobject obj = json::jobject::parse(dom_input);
+	CHECK_EQ(doc["nested"].serialize(), "{\"inner\":[{\"id\":7},\"text\"]}");
+	CHECK_EQ(doc.serialize(), obj.as_string());
+	CHECK_EQ(json::node(obj).serialize(), obj.as_string());
+	CHECK_EQ(doc.as_object().as_string(), obj.as_string());
+	CHECK_EQ(doc.pretty(), obj.pretty());
+}
+
+TEST_CASE("JsonNodeTest - TypedScalars")
+{
+	// Numbers are converted and strings decoded once, the JSON text of numbers and escaped strings is kept
+	const char *typed_input = "[4294967295,-2147483648,2.75,-7,\"a\\/b\\tc\\u0041\",\"plain\",true,null]";
+	json::node typed = json::node::parse(typed_input);
+	CHECK_EQ((unsigned int)typed[0], 4294967295u);
+	CHECK_EQ((long)typed[1], -2147483648L);
+	CHECK_EQ((int)typed[2], 2);
+	CHECK_EQ((double)typed[2], 2.75);
+	CHECK_EQ((float)typed[2], 2.75f);
+	CHECK_EQ((int)typed[3], -7);
+	CHECK_EQ((float)typed[3], -7.0f);
+	CHECK_EQ(typed[4].as_string().substr(0, 5), std::string("a/b\tc"));
+	CHECK_EQ(typed[4].serialize(), std::string("\"a\\/b\\tc\\u0041\""));
+	CHECK_EQ(typed[5].serialize(), std::string("\"plain\""));
+	CHECK_EQ(typed[6].serialize(), std::string("true"));
+	CHECK_EQ(typed[7].serialize(), std::string("null"));
+	CHECK_EQ(typed.serialize(), std::string(typed_input));
+}
+
+TEST_CASE("JsonNodeTest - EscapedKeys")
+{
+	// Keys are stored decoded and must be encoded again when printed
+	json::node escaped = json::node::parse("{\"k\\\"q\":{\"x\\\\y\\n\":1,\"plain\":[true]}}");
+	CHECK_EQ(escaped.key(0), "k\"q");
+	CHECK_EQ(json::node::parse(escaped.pretty()).serialize(), escaped.serialize());
+}
+
+TEST_CASE("JsonNodeTest - Errors")
+{
+	json::node doc = json::node::parse(dom_input);
+	CHECK_THROWS_AS(doc["missing"], json::invalid_key);
+	CHECK_THROWS_AS(doc["count"]["missing"], json::invalid_key);
+	CHECK_THROWS_AS(json::node::parse("{\"a\" 1}"), json::parsing_error);
+	CHECK_THROWS_AS(json::node::parse("[1,]"), json::parsing_error);
+	CHECK_THROWS_AS(json::node::parse("[\"open"), json::parsing_error);
+	CHECK_THROWS_AS(json::node::parse("[01]"), json::parsing_error);
+	CHECK_THROWS_AS(json::node::parse("[tru]"), json::parsing_error);
+	CHECK_THROWS_AS(json::node::parse("  "), json::parsing_error);
+}
+
+#ifdef JSON_USE_PMR
+TEST_CASE("JsonNodeTest - MemoryResource")
+{
+	// The whole document must fit in the buffer since the upstream resource refuses to allocate
+	char buffer[1 << 16];
+	std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+	json::node doc = json::node::parse(dom_input, &arena);
+	CHECK(doc.get_allocator().resource() == &arena);
+	CHECK(doc["nested"]["inner"][0].get_allocator().resource() == &arena);
+	CHECK_EQ(doc.serialize(), json::node::parse(dom_input).serialize());
+	CHECK_EQ(doc.key(4), "nested");
+	CHECK_EQ((int)doc["nested"]["inner"][0]["id"], 7);
+	json::node copy = doc["nested"];
+	CHECK(copy.get_allocator().resource() == std::pmr::get_default_resource());
+	CHECK_EQ(copy.serialize(), "{\"inner\":[{\"id\":7},\"text\"]}");
+}
+#endif
@@ -0,0 +1,68 @@
+#include "json.h"
+#include <doctest/doctest.h>
+#include <cstdio>
+
+static json::jobject make_large_object(const int count)
+{
+	char key[32];
+	json::jobject result;
+	for (int i = 0; i < count; i++)
+	{
+		snprintf(key, sizeof(key), "key%d", i);
+		result[key] = i;
+	}
+	return result;
+}
+
+TEST_CASE("JsonKeyIndexTest - Lookup")
+{
+	json::jobject test = make_large_object(1000);
+	char key[32];
+	CHECK_EQ(test.size(), 1000);
+	for (int i = 0; i < 1000; i++)
+	{
+		snprintf(key, sizeof(key), "key%d", i);
+		CHECK(test.has_key(key));
+		CHECK_EQ((int)test[key], i);
+	}
+	CHECK_FALSE(test.has_key("missing"));
+	CHECK_THROWS_AS(test.get("missing"), json::invalid_key);
+}
+
+TEST_CASE("JsonKeyIndexTest - Modification")
+{
+	json::jobject test = make_large_object(1000);
+	test["key10"] = "updated";
+	CHECK_EQ(test.size(), 1000);
+	CHECK_EQ(test.list_keys().at(10), "key10");
+	CHECK_EQ(test["key10"].as_string(), "updated");
+
+	test.remove("key0");
+	test.remove(499);
+	CHECK_EQ(test.size(), 998);
+	CHECK_FALSE(test.has_key("key0"));
+	CHECK_FALSE(test.has_key("key500"));
+	CHECK_EQ((int)test["key999"], 999);
+	CHECK_EQ(test.list_keys().front(), "key1");
+
+	json::kvp entry("appended", "1");
+	test += entry;
+	CHECK_EQ((int)test["appended"], 1);
+	CHECK_EQ(test.list_keys().back(), "appended");
+	CHECK_THROWS_AS(test += entry, json::parsing_error);
+}
+
+TEST_CASE("JsonKeyIndexTest - CopyAndParse")
+{
+	json::jobject test = make_large_object(1000);
+	json::jobject parsed = json::jobject::parse(test.as_string());
+	CHECK_EQ(parsed.as_string(), test.as_string());
+	CHECK_EQ((int)parsed["key998"], 998);
+	json::jobject assigned;
+	assigned = parsed;
+	CHECK_EQ((int)assigned["key1"], 1);
+	assigned.clear();
+	CHECK_FALSE(assigned.has_key("key1"));
+	assigned["key1"] = 2;
+	CHECK_EQ((int)assigned["key1"], 2);
+}
@@ -0,0 +1,51 @@
+#include "json.h"
+#include <doctest/doctest.h>
+#include <limits.h>
+
+TEST_CASE("JsonNumberTest - RoundTrip")
+{
+	json::jobject test;
+	test["int_min"] = INT_MIN;
+	test["int_max"] = INT_MAX;
+	test["uint_max"] = UINT_MAX;
+	test["long_min"] = LONG_MIN;
+	test["ulong_max"] = ULONG_MAX;
+	test["double"] = 123.456;
+	test["small"] = -1.5e-300;
+	test["float"] = 0.1f;
+
+	json::jobject retest = json::jobject::parse(test.as_string());
+	json::key_list_t keys = retest.list_keys();
+	for (size_t i = 0; i < keys.size(); i++) CHECK(retest[keys[i]].is_number());
+
+	CHECK_EQ((int)retest["int_min"], INT_MIN);
+	CHECK_EQ((int)retest["int_max"], INT_MAX);
+	CHECK_EQ((unsigned int)retest["uint_max"], UINT_MAX);
+	CHECK_EQ((long)retest["long_min"], LONG_MIN);
+	CHECK_EQ((unsigned long)retest["ulong_max"], ULONG_MAX);
+	CHECK_EQ((double)retest["double"], 123.456);
+	CHECK_EQ((double)retest["small"], -1.5e-300);
+	CHECK_EQ((float)retest["float"], 0.1f);
+	CHECK_EQ(retest.get("int_min"), "-2147483648");
+}
+
+TEST_CASE("JsonNumberTest - Arrays")
+{
+	json::jobject test;
+	std::vector<double> doubles;
+	doubles.push_back(0.5);
+	doubles.push_back(-2.25);
+	doubles.push_back(1e10);
+	test["doubles"] = doubles;
+	std::vector<double> doubles_out = test["doubles"];
+	CHECK_EQ(doubles_out.size(), 3);
+	CHECK_EQ(doubles_out[0], 0.5);
+	CHECK_EQ(doubles_out[1], -2.25);
+	CHECK_EQ(doubles_out[2], 1e10);
+}
+
+TEST_CASE("JsonNumberTest - Truncation")
+{
+	CHECK_EQ((int)json::jobject::parse("{\"value\":12.75}")["value"], 12);
+	CHECK_EQ((double)json::jobject::parse("{\"value\":2.5e3}")["value"], 2500.0);
+}
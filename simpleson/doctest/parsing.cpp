@@ -63,3 +63,29 @@ TEST_CASE("JsonReaderTest - ParseNumbers")
         stream.clear();
     }
 }
+
+static const char *spaced_input =
+    " {\n\t\"a long key with \\\"escapes\\\" and \\/ more\" :\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t[ 1 , \"x\" ]\r\n} tail";
+static const char *spaced_output = "{\"a long key with \\\"escapes\\\" and \\/ more\":[1,\"x\"]}";
+
+TEST_CASE("JsonParsingTest - BulkParse")
+{
+    for(size_t i = 0; i < sizeof(test_data) / sizeof(test_struct_t); i++) {
+        const json::parsing::parse_results result = json::parsing::parse(test_data[i].input);
+        CHECK_EQ(result.type, test_data[i].type);
+        CHECK_EQ(std::string(result.value.c_str()), std::string(test_data[i].output));
+        CHECK(*result.remainder == '\0');
+    }
+    for(size_t i = 0; i < sizeof(test_numbers) / sizeof(char*); i++) {
+        const json::parsing::parse_results result = json::parsing::parse(test_numbers[i]);
+        CHECK_EQ(result.type, json::jtype::jnumber);
+        CHECK_EQ(std::string(result.value.c_str()), std::string(test_numbers[i]));
+    }
+    const json::parsing::parse_results spaced = json::parsing::parse(spaced_input);
+    CHECK_EQ(spaced.type, json::jtype::jobject);
+    CHECK_EQ(std::string(spaced.value.c_str()), std::string(spaced_output));
+    CHECK_EQ(std::string(spaced.remainder), std::string(" tail"));
+    CHECK_EQ(json::parsing::parse("[1,]").type, json::jtype::not_valid);
+    CHECK_EQ(json::parsing::parse("[\"open").type, json::jtype::not_valid);
+    CHECK_EQ(json::parsing::parse("\"bad \\q\"").type, json::jtype::not_valid);
+}
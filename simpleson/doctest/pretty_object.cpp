@@ -67,3 +67,11 @@ TEST_CASE("JsonPrettyPrintTest - ParseAndFormatObject")
     json::jobject copy(result);
     CHECK_EQ(strcmp(copy.as_string().c_str(), result.as_string().c_str()), 0);
 }
+
+TEST_CASE("JsonPrettyPrintTest - InvalidValue")
+{
+    // Values which are not valid JSON are printed as they are stored
+    json::jobject invalid;
+    invalid["x"] = nan("");
+    CHECK_EQ(strcmp(invalid.pretty().c_str(), "{\n\t\"x\": nan\n}"), 0);
+}
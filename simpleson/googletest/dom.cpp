@@ -0,0 +1,103 @@
+#include "json.h"
+#include <gtest/gtest.h>
+
+static const char *dom_input = "{\"name\": \"hello \\\"world\\\"\", \"count\": 42, \"ratio\": -1.5e2, \"flags\": [true, false, null],"
+	" \"nested\": {\"inner\": [{\"id\": 7}, \"text\"]}, \"empty\": {}}";
+
+TEST(JsonNodeTest, Scalars)
+{
+	json::node doc = json::node::parse(dom_input);
+	EXPECT_TRUE(doc.is_object());
+	EXPECT_FALSE(doc.is_array());
+	EXPECT_EQ(doc.size(), 6u);
+	EXPECT_TRUE(doc.has_key("nested"));
+	EXPECT_FALSE(doc.has_key("missing"));
+	EXPECT_EQ(doc.key(1), "count");
+	EXPECT_TRUE(doc["name"].is_string());
+	EXPECT_EQ(doc["name"].as_string(), "hello \"world\"");
+	EXPECT_TRUE(doc["count"].is_number());
+	EXPECT_EQ((int)doc["count"], 42);
+	EXPECT_DOUBLE_EQ((double)doc["ratio"], -150.0);
+	EXPECT_TRUE(doc["flags"][0].is_true());
+	EXPECT_TRUE(doc["flags"][1].is_bool());
+	EXPECT_FALSE(doc["flags"][1].is_true());
+	EXPECT_TRUE(doc["flags"][2].is_null());
+}
+
+TEST(JsonNodeTest, NestedAccess)
+{
+	json::node doc = json::node::parse(dom_input);
+	EXPECT_EQ((int)doc["nested"]["inner"][0]["id"], 7);
+	EXPECT_EQ(doc["nested"]["inner"][1].as_string(), "text");
+	EXPECT_EQ(doc["empty"].size(), 0u);
+}
+
+TEST(JsonNodeTest, Serialization)
+{
+	json::node doc = json::node::parse(dom_input);
+	json::jobject obj = json::jobject::parse(dom_input);
+	EXPECT_EQ(doc["nested"].serialize(), "{\"inner\":[{\"id\":7},\"text\"]}");
+	EXPECT_EQ(doc.serialize(), obj.as_string());
+	EXPECT_EQ(json::node(obj).serialize(), obj.as_string());
+	EXPECT_EQ(doc.as_object().as_string(), obj.as_string());
+	EXPECT_EQ(doc.pretty(), obj.pretty());
+}
+
+TEST(JsonNodeTest, TypedScalars)
+{
+	// Numbers are converted and strings decoded once, the JSON text of numbers and escaped strings is kept
+	const char *typed_input = "[4294967295,-2147483648,2.75,-7,\"a\\/b\\tc\\u0041\",\"plain\",true,null]";
+	json::node typed = json::node::parse(typed_input);
+	EXPECT_EQ((unsigned int)typed[0], 4294967295u);
+	EXPECT_EQ((long)typed[1], -2147483648L);
+	EXPECT_EQ((int)typed[2], 2);
+	EXPECT_EQ((double)typed[2], 2.75);
+	EXPECT_EQ((float)typed[2], 2.75f);
+	EXPECT_EQ((int)typed[3], -7);
+	EXPECT_EQ((float)typed[3], -7.0f);
+	EXPECT_EQ(typed[4].as_string().substr(0, 5), "a/b\tc");
+	EXPECT_EQ(typed[4].serialize(), "\"a\\/b\\tc\\u0041\"");
+	EXPECT_EQ(typed[5].serialize(), "\"plain\"");
+	EXPECT_EQ(typed[6].serialize(), "true");
+	EXPECT_EQ(typed[7].serialize(), "null");
+	EXPECT_EQ(typed.serialize(), typed_input);
+}
+
+TEST(JsonNodeTest, EscapedKeys)
+{
+	// Keys are stored decoded and must be encoded again when printed
+	json::node escaped = json::node::parse("{\"k\\\"q\":{\"x\\\\y\\n\":1,\"plain\":[true]}}");
+	EXPECT_EQ(escaped.key(0), "k\"q");
+	EXPECT_EQ(json::node::parse(escaped.pretty()).serialize(), escaped.serialize());
+}
+
+TEST(JsonNodeTest, Errors)
+{
+	json::node doc = json::node::parse(dom_input);
+	EXPECT_THROW(doc["missing"], json::invalid_key);
+	EXPECT_THROW(doc["count"]["missing"], json::invalid_key);
+	EXPECT_THROW(json::node::parse("{\"a\" 1}"), json::parsing_error);
+	EXPECT_THROW(json::node::parse("[1,]"), json::parsing_error);
+	EXPECT_THROW(json::node::parse("[\"open"), json::parsing_error);
+	EXPECT_THROW(json::node::parse("[01]"), json::parsing_error);
+	EXPECT_THROW(json::node::parse("[tru]"), json::parsing_error);
+	EXPECT_THROW(json::node::parse("  "), json::parsing_error);
+}
+
+#ifdef JSON_USE_PMR
+TEST(JsonNodeTest, MemoryResource)
+{
+	// The whole document must fit in the buffer since the upstream resource refuses to allocate
+	char buffer[1 << 16];
+	std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+	json::node doc = json::node::parse(dom_input, &arena);
+	EXPECT_TRUE(doc.get_allocator().resource() == &arena);
+	EXPECT_TRUE(doc["nested"]["inner"][0].get_allocator().resource() == &arena);
+	EXPECT_EQ(doc.serialize(), json::node::parse(dom_input).serialize());
+	EXPECT_EQ(doc.key(4), "nested");
+	EXPECT_EQ((int)doc["nested"]["inner"][0]["id"], 7);
+	json::node copy = doc["nested"];
+	EXPECT_TRUE(copy.get_allocator().resource() == std::pmr::get_default_resource());
+	EXPECT_EQ(copy.serialize(), "{\"inner\":[{\"id\":7},\"text\"]}");
+}
+#endif
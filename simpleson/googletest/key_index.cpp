@@ -0,0 +1,68 @@
+#include "json.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+
+static json::jobject make_large_object(const int count)
+{
+	char key[32];
+	json::jobject result;
+	for (int i = 0; i < count; i++)
+	{
+		snprintf(key, sizeof(key), "key%d", i);
+		result[key] = i;
+	}
+	return result;
+}
+
+TEST(JsonKeyIndexTest, Lookup)
+{
+	json::jobject test = make_large_object(1000);
+	char key[32];
+	EXPECT_EQ(test.size(), 1000u);
+	for (int i = 0; i < 1000; i++)
+	{
+		snprintf(key, sizeof(key), "key%d", i);
+		EXPECT_TRUE(test.has_key(key));
+		EXPECT_EQ((int)test[key], i);
+	}
+	EXPECT_FALSE(test.has_key("missing"));
+	EXPECT_THROW(test.get("missing"), json::invalid_key);
+}
+
+TEST(JsonKeyIndexTest, Modification)
+{
+	json::jobject test = make_large_object(1000);
+	test["key10"] = "updated";
+	EXPECT_EQ(test.size(), 1000u);
+	EXPECT_EQ(test.list_keys().at(10), "key10");
+	EXPECT_EQ(test["key10"].as_string(), "updated");
+
+	test.remove("key0");
+	test.remove(499);
+	EXPECT_EQ(test.size(), 998u);
+	EXPECT_FALSE(test.has_key("key0"));
+	EXPECT_FALSE(test.has_key("key500"));
+	EXPECT_EQ((int)test["key999"], 999);
+	EXPECT_EQ(test.list_keys().front(), "key1");
+
+	json::kvp entry("appended", "1");
+	test += entry;
+	EXPECT_EQ((int)test["appended"], 1);
+	EXPECT_EQ(test.list_keys().back(), "appended");
+	EXPECT_THROW(test += entry, json::parsing_error);
+}
+
+TEST(JsonKeyIndexTest, CopyAndParse)
+{
+	json::jobject test = make_large_object(1000);
+	json::jobject parsed = json::jobject::parse(test.as_string());
+	EXPECT_EQ(parsed.as_string(), test.as_string());
+	EXPECT_EQ((int)parsed["key998"], 998);
+	json::jobject assigned;
+	assigned = parsed;
+	EXPECT_EQ((int)assigned["key1"], 1);
+	assigned.clear();
+	EXPECT_FALSE(assigned.has_key("key1"));
+	assigned["key1"] = 2;
+	EXPECT_EQ((int)assigned["key1"], 2);
+}
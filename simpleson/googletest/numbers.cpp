@@ -0,0 +1,51 @@
+#include "json.h"
+#include <gtest/gtest.h>
+#include <limits.h>
+
+TEST(JsonNumberTest, RoundTrip)
+{
+	json::jobject test;
+	test["int_min"] = INT_MIN;
+	test["int_max"] = INT_MAX;
+	test["uint_max"] = UINT_MAX;
+	test["long_min"] = LONG_MIN;
+	test["ulong_max"] = ULONG_MAX;
+	test["double"] = 123.456;
+	test["small"] = -1.5e-300;
+	test["float"] = 0.1f;
+
+	json::jobject retest = json::jobject::parse(test.as_string());
+	json::key_list_t keys = retest.list_keys();
+	for (size_t i = 0; i < keys.size(); i++) EXPECT_TRUE(retest[keys[i]].is_number());
+
+	EXPECT_EQ((int)retest["int_min"], INT_MIN);
+	EXPECT_EQ((int)retest["int_max"], INT_MAX);
+	EXPECT_EQ((unsigned int)retest["uint_max"], UINT_MAX);
+	EXPECT_EQ((long)retest["long_min"], LONG_MIN);
+	EXPECT_EQ((unsigned long)retest["ulong_max"], ULONG_MAX);
+	EXPECT_DOUBLE_EQ((double)retest["double"], 123.456);
+	EXPECT_DOUBLE_EQ((double)retest["small"], -1.5e-300);
+	EXPECT_FLOAT_EQ((float)retest["float"], 0.1f);
+	EXPECT_EQ(retest.get("int_min"), "-2147483648");
+}
+
+TEST(JsonNumberTest, Arrays)
+{
+	json::jobject test;
+	std::vector<double> doubles;
+	doubles.push_back(0.5);
+	doubles.push_back(-2.25);
+	doubles.push_back(1e10);
+	test["doubles"] = doubles;
+	std::vector<double> doubles_out = test["doubles"];
+	EXPECT_EQ(doubles_out.size(), 3u);
+	EXPECT_EQ(doubles_out[0], 0.5);
+	EXPECT_EQ(doubles_out[1], -2.25);
+	EXPECT_EQ(doubles_out[2], 1e10);
+}
+
+TEST(JsonNumberTest, Truncation)
+{
+	EXPECT_EQ((int)json::jobject::parse("{\"value\":12.75}")["value"], 12);
+	EXPECT_DOUBLE_EQ((double)json::jobject::parse("{\"value\":2.5e3}")["value"], 2500.0);
+}
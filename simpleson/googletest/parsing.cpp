@@ -68,3 +68,29 @@ TEST_F(JsonReaderTest, ParseNumbers)
         stream.clear();
     }
 }
+
+static const char *spaced_input =
+    " {\n\t\"a long key with \\\"escapes\\\" and \\/ more\" :\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t[ 1 , \"x\" ]\r\n} tail";
+static const char *spaced_output = "{\"a long key with \\\"escapes\\\" and \\/ more\":[1,\"x\"]}";
+
+TEST(JsonParsingTest, BulkParse)
+{
+    for(size_t i = 0; i < sizeof(test_data) / sizeof(test_struct_t); i++) {
+        const json::parsing::parse_results result = json::parsing::parse(test_data[i].input);
+        EXPECT_EQ(result.type, test_data[i].type);
+        EXPECT_STREQ(result.value.c_str(), test_data[i].output);
+        EXPECT_TRUE(*result.remainder == '\0');
+    }
+    for(size_t i = 0; i < sizeof(test_numbers) / sizeof(char*); i++) {
+        const json::parsing::parse_results result = json::parsing::parse(test_numbers[i]);
+        EXPECT_EQ(result.type, json::jtype::jnumber);
+        EXPECT_STREQ(result.value.c_str(), test_numbers[i]);
+    }
+    const json::parsing::parse_results spaced = json::parsing::parse(spaced_input);
+    EXPECT_EQ(spaced.type, json::jtype::jobject);
+    EXPECT_STREQ(spaced.value.c_str(), spaced_output);
+    EXPECT_STREQ(spaced.remainder, " tail");
+    EXPECT_EQ(json::parsing::parse("[1,]").type, json::jtype::not_valid);
+    EXPECT_EQ(json::parsing::parse("[\"open").type, json::jtype::not_valid);
+    EXPECT_EQ(json::parsing::parse("\"bad \\q\"").type, json::jtype::not_valid);
+}
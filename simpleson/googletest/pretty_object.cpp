@@ -66,3 +66,11 @@ TEST(JsonPrettyPrintTest, ParseAndFormatObject)
     json::jobject copy(result);
     ASSERT_STREQ(copy.as_string().c_str(), result.as_string().c_str());
 }
+
+TEST(JsonPrettyPrintTest, InvalidValue)
+{
+    // Values which are not valid JSON are printed as they are stored
+    json::jobject invalid;
+    invalid["x"] = nan("");
+    ASSERT_STREQ(invalid.pretty().c_str(), "{\n\t\"x\": nan\n}");
+}
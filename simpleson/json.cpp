@@ -5,6 +5,8 @@
 #include "json.h"
 #include <string.h>
 #include <assert.h>
+#include <errno.h>
+#include <limits>
 
 /*! \brief Checks for an empty string
  * 
@@ -33,6 +35,50 @@
  */
 #define IS_DIGIT(input) (input >= '0' && input <= '9')
 
+/*! \brief Determines if the supplied character is white space, matching std::isspace in the "C" locale
+ *
+ * @param input The character to be tested
+ */
+#define IS_WHITE_SPACE(input) (input == ' ' || (input >= '\t' && input <= '\r'))
+
+#if !defined(JSON_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+/*! \brief Set when the bulk parser scans its input 16 bytes at a time using SSE2
+ *
+ * Define JSON_NO_SIMD to force the scalar loops
+ */
+#define JSON_SSE2 1
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if !defined(JSON_NO_CHARCONV) && (__cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)) && defined(__has_include)
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+#endif
+
+/*! \brief Set when numbers are converted with std::from_chars and std::to_chars
+ *
+ * \details Requires C++17 and a standard library with floating-point support in <charconv>. Define JSON_NO_CHARCONV to
+ * convert numbers with std::sscanf and std::snprintf instead.
+ */
+#if defined(__cpp_lib_to_chars)
+#define JSON_CHARCONV 1
+#endif
+
+/*! \brief Disables address sanitizer checks on functions that read whole aligned blocks
+ *
+ * Aligned 16 byte loads never cross a page boundary, so reading past the null terminator is safe,
+ * but the sanitizer reports the bytes past the end of the allocation
+ */
+#if defined(__clang__) || defined(__GNUC__)
+#define JSON_NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address))
+#else
+#define JSON_NO_SANITIZE_ADDRESS
+#endif
+
 /*! \brief Format used for integer to string conversion */
 const char * INT_FORMAT = "%i";
 
@@ -208,6 +254,7 @@ bool is_control_character(const char input)
     case 't':
     case '"':
     case '\\':
+    case '/':
         return true;
     default:
         return false;
@@ -764,6 +811,258 @@ std::string json::parsing::encode_string(const char *input)
     return result;
 }
 
+#if JSON_SSE2
+/*! \brief Returns the index of the lowest set bit of a non-zero mask */
+static inline unsigned int first_set_bit(const unsigned int mask)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+/*! \brief Returns a mask of the bytes in an aligned block that are a quote, a backslash or the null terminator */
+JSON_NO_SANITIZE_ADDRESS static inline unsigned int string_special_mask(const char *block)
+{
+    const __m128i data = _mm_load_si128(reinterpret_cast<const __m128i*>(block));
+    const __m128i special = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(data, _mm_set1_epi8('"')), _mm_cmpeq_epi8(data, _mm_set1_epi8('\\'))),
+        _mm_cmpeq_epi8(data, _mm_setzero_si128()));
+    return static_cast<unsigned int>(_mm_movemask_epi8(special));
+}
+
+/*! \brief Returns a mask of the bytes in an aligned block that are not white space */
+JSON_NO_SANITIZE_ADDRESS static inline unsigned int non_white_space_mask(const char *block)
+{
+    const __m128i data = _mm_load_si128(reinterpret_cast<const __m128i*>(block));
+    // '\t' through '\r' are contiguous, so an unsigned range check covers them in one comparison
+    const __m128i control = _mm_subs_epu8(_mm_sub_epi8(data, _mm_set1_epi8('\t')), _mm_set1_epi8('\r' - '\t'));
+    const __m128i space = _mm_or_si128(
+        _mm_cmpeq_epi8(data, _mm_set1_epi8(' ')),
+        _mm_cmpeq_epi8(control, _mm_setzero_si128()));
+    return ~static_cast<unsigned int>(_mm_movemask_epi8(space)) & 0xFFFF;
+}
+#endif
+
+/*! \brief Returns a pointer to the first quote, backslash or null terminator at or after the input */
+static const char* find_string_special(const char *input)
+{
+#if JSON_SSE2
+    const size_t offset = reinterpret_cast<size_t>(input) & 15;
+    const char *block = input - offset;
+    unsigned int mask = string_special_mask(block) >> offset << offset;
+    while (mask == 0)
+    {
+        block += 16;
+        mask = string_special_mask(block);
+    }
+    return block + first_set_bit(mask);
+#else
+    while (*input != '"' && *input != '\\' && !EMPTY_STRING(input)) input++;
+    return input;
+#endif
+}
+
+/*! \brief Returns a pointer to the first character at or after the input that is not white space */
+static const char* skip_white_space(const char *input)
+{
+    // Most values are separated by no or a single white space character
+    if (!IS_WHITE_SPACE(*input)) return input;
+    input++;
+    if (!IS_WHITE_SPACE(*input)) return input;
+#if JSON_SSE2
+    const size_t offset = reinterpret_cast<size_t>(input) & 15;
+    const char *block = input - offset;
+    unsigned int mask = non_white_space_mask(block) >> offset << offset;
+    while (mask == 0)
+    {
+        block += 16;
+        mask = non_white_space_mask(block);
+    }
+    return block + first_set_bit(mask);
+#else
+    while (IS_WHITE_SPACE(*input)) input++;
+    return input;
+#endif
+}
+
+/*! \brief Reads a string, including its quotes, in bulk
+ *
+ * @param input A pointer to the opening quote
+ * @param output The string the raw text is appended to
+ * @return A pointer to the character after the closing quote, or NULL if the string is not valid
+ */
+template <typename string_t>
+static const char* read_string(const char *input, string_t &output)
+{
+    assert(*input == '"');
+    const char *index = input + 1;
+    while (true)
+    {
+        index = find_string_special(index);
+        switch (*index)
+        {
+        case '"':
+            index++;
+            output.append(input, index);
+            return index;
+        case '\\':
+            index++;
+            if (*index == 'u') {
+                for (int i = 1; i <= 4; i++) if (!is_hex_digit(index[i])) return NULL;
+                index += 5;
+            } else if (is_control_character(*index)) {
+                index++;
+            } else {
+                return NULL;
+            }
+            break;
+        default:
+            return NULL;
+        }
+    }
+}
+
+/*! \brief Discards the text read by read_string, for strings that are only validated */
+struct discarded_text
+{
+    /*! \brief Ignores the supplied range */
+    void append(const char *, const char *) { }
+};
+
+/*! \brief Reads a string and stores its decoded text
+ *
+ * @param input A pointer to the opening quote
+ * @param output Set to the text between the quotes with the escape sequences decoded
+ * @param escaped If not NULL, set to the JSON text of a string with escape sequences and cleared otherwise
+ * @return A pointer to the character after the closing quote, or NULL if the string is not valid
+ */
+static const char* read_decoded_string(const char *input, json::node::string_type &output, json::node::string_type *escaped)
+{
+    discarded_text validated;
+    const char *end = read_string(input, validated);
+    if (end == NULL) return NULL;
+    if (memchr(input, '\\', end - input) == NULL) {
+        // Nothing to decode, so the text is copied from the input
+        output.assign(input + 1, end - input - 2);
+        if (escaped != NULL) escaped->clear();
+    } else {
+        const std::string decoded = json::parsing::decode_string(input);
+        output.assign(decoded.data(), decoded.size());
+        if (escaped != NULL) escaped->assign(input, end - input);
+    }
+    return end;
+}
+
+/*! \brief Reads a number in bulk
+ *
+ * @param input A pointer to the first character of the number
+ * @param output The string the raw text is appended to
+ * @return A pointer to the character after the number, or NULL if the number is not valid
+ */
+template <typename string_t>
+static const char* read_number(const char *input, string_t &output)
+{
+    const char *index = input;
+    if (*index == '-') index++;
+    if (*index == '0') {
+        index++;
+    } else {
+        if (!IS_DIGIT(*index)) return NULL;
+        while (IS_DIGIT(*index)) index++;
+    }
+    if (*index == '.') {
+        index++;
+        if (!IS_DIGIT(*index)) return NULL;
+        while (IS_DIGIT(*index)) index++;
+    }
+    if (*index == 'e' || *index == 'E') {
+        index++;
+        if (*index == '+' || *index == '-') index++;
+        if (!IS_DIGIT(*index)) return NULL;
+        while (IS_DIGIT(*index)) index++;
+    }
+    output.append(input, index);
+    return index;
+}
+
+/*! \brief Reads a JSON value in bulk
+ *
+ * This is the block-at-a-time counterpart of json::reader. It produces the same output, dropping the white space
+ * outside of strings, but walks the input with tight loops instead of pushing one character at a time.
+ *
+ * @param input A pointer to the first character of the value
+ * @param output The string the value is appended to
+ * @param type Set to the type of the value
+ * @return A pointer to the character after the value, or NULL if the value is not valid
+ */
+template <typename string_t>
+static const char* read_value(const char *input, string_t &output, json::jtype::jtype &type)
+{
+    type = json::jtype::peek(*input);
+    switch (type)
+    {
+    case json::jtype::jarray:
+    case json::jtype::jobject:
+        break;
+    case json::jtype::jstring:
+        return read_string(input, output);
+    case json::jtype::jnumber:
+        return read_number(input, output);
+    case json::jtype::jbool:
+        if (strncmp(input, "true", 4) == 0) {
+            output.append(input, 4);
+            return input + 4;
+        }
+        if (strncmp(input, "false", 5) == 0) {
+            output.append(input, 5);
+            return input + 5;
+        }
+        return NULL;
+    case json::jtype::jnull:
+        if (strncmp(input, "null", 4) != 0) return NULL;
+        output.append(input, 4);
+        return input + 4;
+    case json::jtype::not_valid:
+        return NULL;
+    }
+
+    const bool is_array = type == json::jtype::jarray;
+    const char closing = is_array ? ']' : '}';
+    json::jtype::jtype value_type;
+    output.push_back(*input);
+    const char *index = skip_white_space(input + 1);
+    if (*index == closing) {
+        output.push_back(closing);
+        return index + 1;
+    }
+    while (true)
+    {
+        if (!is_array) {
+            if (*index != '"') return NULL;
+            index = read_string(index, output);
+            if (index == NULL) return NULL;
+            index = skip_white_space(index);
+            if (*index != ':') return NULL;
+            output.push_back(':');
+            index = skip_white_space(index + 1);
+        }
+        index = read_value(index, output, value_type);
+        if (index == NULL) return NULL;
+        index = skip_white_space(index);
+        if (*index == closing) {
+            output.push_back(closing);
+            return index + 1;
+        }
+        if (*index != ',') return NULL;
+        output.push_back(',');
+        index = skip_white_space(index + 1);
+    }
+}
+
 json::parsing::parse_results json::parsing::parse(const char *input)
 {
     // Strip white space
@@ -774,22 +1073,18 @@ json::parsing::parse_results json::parsing::parse(const char *input)
 
     // Initialize the output
     json::parsing::parse_results result;
-    result.type = json::jtype::not_valid;
 
-    // Initialize the reader
-    json::reader stream;
-
-    // Iterate
-    while(!EMPTY_STRING(input) && stream.push(*index) != json::reader::REJECTED)
-    {
-        index++;
-    }
-
-    if(stream.is_valid()) {
-        result.value = stream.readout();
-        result.type = stream.type();
+    // Read the whole value in bulk
+    json::jtype::jtype type;
+    const char *end = read_value(index, result.value, type);
+    if (end == NULL) {
+        result.value.clear();
+        result.type = json::jtype::not_valid;
+        result.remainder = index;
+    } else {
+        result.type = type;
+        result.remainder = end;
     }
-    result.remainder = index;
 
     return result;
 }
@@ -827,6 +1122,47 @@ std::vector<std::string> json::parsing::parse_array(const char *input)
     return result;
 }
 
+#if JSON_CHARCONV
+/*! \brief Converts the number at the start of a null-terminated string with std::from_chars */
+template <typename T>
+static bool from_chars_number(const char *input, T &output)
+{
+    T value;
+    const std::from_chars_result result = std::from_chars(input, input + strlen(input), value);
+    if (result.ec != std::errc()) return false;
+    output = value;
+    return true;
+}
+
+/*! \brief Converts a number to a string with std::to_chars */
+template <typename T>
+static bool to_chars_number(const T number, std::string &output)
+{
+    char buffer[64];
+    const std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), number);
+    if (result.ec != std::errc()) return false;
+    output.assign(buffer, result.ptr);
+    return true;
+}
+
+/*! \brief Defines the number conversions of a type */
+#define NUMBER_CONVERSIONS(type) \
+    bool json::parsing::number_from_chars(const char *input, type &output) { return from_chars_number(input, output); } \
+    bool json::parsing::number_to_chars(const type number, std::string &output) { return to_chars_number(number, output); }
+#else
+/*! \brief Defines the number conversions of a type, which are not available with this standard library */
+#define NUMBER_CONVERSIONS(type) \
+    bool json::parsing::number_from_chars(const char *, type &) { return false; } \
+    bool json::parsing::number_to_chars(const type, std::string &) { return false; }
+#endif
+
+NUMBER_CONVERSIONS(int)
+NUMBER_CONVERSIONS(unsigned int)
+NUMBER_CONVERSIONS(long)
+NUMBER_CONVERSIONS(unsigned long)
+NUMBER_CONVERSIONS(float)
+NUMBER_CONVERSIONS(double)
+
 json::jobject::entry::operator int() const { return this->get_number<int>(INT_FORMAT); }
 json::jobject::entry::operator unsigned int() const { return this->get_number<unsigned int>(UINT_FORMAT); }
 json::jobject::entry::operator long() const { return this->get_number<long>(LONG_FORMAT); }
@@ -928,32 +1264,84 @@ json::key_list_t json::jobject::list_keys() const
     return result;
 }
 
-void json::jobject::set(const std::string &key, const std::string &value)
+/*! \brief Hashes a key for the key index of a JSON object (FNV-1a) */
+static size_t hash_key(const std::string &key)
 {
-    if(this->array_flag) throw json::invalid_key(key);
-    for (size_t i = 0; i < this->size(); i++)
+    size_t hash = 2166136261u;
+    for (size_t i = 0; i < key.size(); i++)
+    {
+        hash ^= static_cast<unsigned char>(key[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+size_t json::jobject::find(const std::string &key) const
+{
+    if (!this->key_index.empty())
     {
-        if (this->data.at(i).first == key)
+        const size_t hash = hash_key(key);
+        const size_t mask = this->key_index.size() - 1;
+        for (size_t slot = hash & mask; this->key_index[slot].second != 0; slot = (slot + 1) & mask)
         {
-            this->data.at(i).second = value;
-            return;
+            const size_t position = this->key_index[slot].second - 1;
+            if (this->key_index[slot].first == hash && this->data[position].first == key) return position;
         }
+        return this->size();
+    }
+    for (size_t i = 0; i < this->size(); i++) if (this->data.at(i).first == key) return i;
+    return this->size();
+}
+
+void json::jobject::build_key_index()
+{
+    this->key_index.clear();
+#if JSON_KEY_INDEX_THRESHOLD > 0
+    if (this->array_flag || this->size() < JSON_KEY_INDEX_THRESHOLD) return;
+
+    // At most half full, so that probe sequences stay short
+    size_t capacity = 64;
+    while (capacity < this->size() * 2) capacity *= 2;
+    this->key_index.resize(capacity);
+    for (size_t i = 0; i < this->size(); i++) this->index_key(i);
+#endif
+}
+
+void json::jobject::update_key_index()
+{
+    if (this->key_index.empty() || this->size() * 2 > this->key_index.size()) this->build_key_index();
+    else this->index_key(this->size() - 1);
+}
+
+void json::jobject::index_key(const size_t position)
+{
+    const size_t hash = hash_key(this->data[position].first);
+    const size_t mask = this->key_index.size() - 1;
+    size_t slot = hash & mask;
+    while (this->key_index[slot].second != 0) slot = (slot + 1) & mask;
+    this->key_index[slot] = std::make_pair(hash, position + 1);
+}
+
+void json::jobject::set(const std::string &key, const std::string &value)
+{
+    if(this->array_flag) throw json::invalid_key(key);
+    const size_t position = this->find(key);
+    if (position < this->size())
+    {
+        this->data.at(position).second = value;
+        return;
     }
     kvp entry;
     entry.first = key;
     entry.second = value;
     this->data.push_back(entry);
+    this->update_key_index();
 }
 
 void json::jobject::remove(const std::string &key)
 {
-    for (size_t i = 0; i < this->size(); i++)
-    {
-        if (this->data.at(i).first == key)
-        {
-            this->remove(i);
-        }
-    }
+    const size_t position = this->find(key);
+    if (position < this->size()) this->remove(position);
 }
 
 json::jobject::operator std::string() const
@@ -1036,4 +1424,263 @@ std::string json::jobject::pretty(unsigned int indent_level) const
         result += "}";
     }
     return result;
-}
\ No newline at end of file
+}
+
+const char* json::node::parse_value(const char *input, json::node &output)
+{
+    const char error[] = "Input is not valid JSON";
+    const char *index = skip_white_space(input);
+    output._type = json::jtype::peek(*index);
+    output._value.clear();
+    output._escaped.clear();
+    output._keys.clear();
+    output._children.clear();
+    output._boolean = false;
+
+    switch (output._type)
+    {
+    case json::jtype::jobject:
+    case json::jtype::jarray:
+    {
+        const bool is_array = output._type == json::jtype::jarray;
+        const char closing = is_array ? ']' : '}';
+        const char *key_end;
+        index = skip_white_space(index + 1);
+        if (*index == closing) return index + 1;
+        while (true)
+        {
+            if (!is_array)
+            {
+                if (*index != '"') throw json::parsing_error(error);
+                output._keys.resize(output._keys.size() + 1);
+                key_end = read_decoded_string(index, output._keys.back(), NULL);
+                if (key_end == NULL) throw json::parsing_error(error);
+                index = skip_white_space(key_end);
+                if (*index != ':') throw json::parsing_error(error);
+                index++;
+            }
+            // Resizing constructs the child with the parent's allocator
+            output._children.resize(output._children.size() + 1);
+            index = skip_white_space(parse_value(index, output._children.back()));
+            if (*index == closing) return index + 1;
+            if (*index != ',') throw json::parsing_error(error);
+            index = skip_white_space(index + 1);
+        }
+    }
+    case json::jtype::jstring:
+        index = read_decoded_string(index, output._value, &output._escaped);
+        if (index == NULL) throw json::parsing_error(error);
+        return index;
+    case json::jtype::jnumber:
+    {
+        index = read_number(index, output._value);
+        if (index == NULL) throw json::parsing_error(error);
+        // The text is kept so the number is serialized as it was written
+        const char *text = output._value.c_str();
+        char *end;
+        errno = 0;
+        output._number_kind = NUMBER_INTEGER;
+        output._number.integer = strtol(text, &end, 10);
+        if (errno == 0 && EMPTY_STRING(end)) return index;
+        if (*text != '-') {
+            errno = 0;
+            output._number_kind = NUMBER_UNSIGNED;
+            output._number.uinteger = strtoul(text, &end, 10);
+            if (errno == 0 && EMPTY_STRING(end)) return index;
+        }
+        output._number_kind = NUMBER_REAL;
+        output._number.real = json::parsing::get_number<double>(text, DOUBLE_FORMAT);
+        return index;
+    }
+    case json::jtype::jbool:
+        if (strncmp(index, "true", 4) == 0) {
+            output._boolean = true;
+            return index + 4;
+        }
+        if (strncmp(index, "false", 5) == 0) return index + 5;
+        throw json::parsing_error(error);
+    case json::jtype::jnull:
+        if (strncmp(index, "null", 4) != 0) throw json::parsing_error(error);
+        return index + 4;
+    case json::jtype::not_valid:
+        break;
+    }
+    if (EMPTY_STRING(index)) throw json::parsing_error("Input was only whitespace");
+    throw json::parsing_error(error);
+}
+
+json::node json::node::parse(const char *input)
+{
+    json::node result;
+    json::node::parse_value(input, result);
+    return result;
+}
+
+#ifdef JSON_USE_PMR
+json::node json::node::parse(const char *input, const json::node::allocator_type &allocator)
+{
+    json::node result(allocator);
+    json::node::parse_value(input, result);
+    return result;
+}
+#endif
+
+json::node::node(const json::jobject &object)
+    : _type(object.is_array() ? json::jtype::jarray : json::jtype::jobject),
+    _children(object.size()),
+    _boolean(false),
+    _number_kind(NUMBER_INTEGER)
+{
+    this->_number.integer = 0;
+    const json::key_list_t keys = object.list_keys();
+    for (size_t i = 0; i < keys.size(); i++) this->_keys.push_back(json::node::string_type(keys[i].data(), keys[i].size()));
+    for (size_t i = 0; i < object.size(); i++)
+    {
+        json::node::parse_value(object.get(i).c_str(), this->_children[i]);
+    }
+}
+
+/*! \brief Compares a stored key with a key supplied by the caller
+ *
+ * \details The stored key may use a different allocator than std::string
+ */
+static bool key_equals(const json::node::string_type &stored, const std::string &key)
+{
+    return stored.size() == key.size() && memcmp(stored.data(), key.data(), key.size()) == 0;
+}
+
+bool json::node::has_key(const std::string &key) const
+{
+    for (size_t i = 0; i < this->_keys.size(); i++) if (key_equals(this->_keys[i], key)) return true;
+    return false;
+}
+
+json::key_list_t json::node::list_keys() const
+{
+    json::key_list_t result;
+    for (size_t i = 0; i < this->_keys.size(); i++) result.push_back(this->key(i));
+    return result;
+}
+
+const json::node& json::node::operator[](const std::string &key) const
+{
+    for (size_t i = 0; i < this->_keys.size(); i++) if (key_equals(this->_keys[i], key)) return this->_children[i];
+    throw json::invalid_key(key);
+}
+
+std::string json::node::as_string() const
+{
+    return this->_type == json::jtype::jstring ? std::string(this->_value.data(), this->_value.size()) : this->serialize();
+}
+
+template <typename T>
+T json::node::number_as(const char *format) const
+{
+    if (this->_type != json::jtype::jnumber) return json::parsing::get_number<T>(this->serialize().c_str(), format);
+    const bool is_integer = std::numeric_limits<T>::is_integer;
+    switch (this->_number_kind)
+    {
+    case NUMBER_INTEGER:
+    {
+        const T result = static_cast<T>(this->_number.integer);
+        if (!is_integer) return result;
+        if (static_cast<long>(result) == this->_number.integer && (this->_number.integer >= 0 || std::numeric_limits<T>::is_signed)) return result;
+        break;
+    }
+    case NUMBER_UNSIGNED:
+    {
+        const T result = static_cast<T>(this->_number.uinteger);
+        if (!is_integer) return result;
+        if (static_cast<unsigned long>(result) == this->_number.uinteger && !std::numeric_limits<T>::is_signed) return result;
+        break;
+    }
+    case NUMBER_REAL:
+        // Narrower types are converted from the text, which avoids rounding twice
+        if (!is_integer && sizeof(T) == sizeof(double)) return static_cast<T>(this->_number.real);
+        break;
+    }
+    return json::parsing::get_number<T>(this->_value.c_str(), format);
+}
+
+json::node::operator int() const { return this->number_as<int>(INT_FORMAT); }
+json::node::operator unsigned int() const { return this->number_as<unsigned int>(UINT_FORMAT); }
+json::node::operator long() const { return this->number_as<long>(LONG_FORMAT); }
+json::node::operator unsigned long() const { return this->number_as<unsigned long>(ULONG_FORMAT); }
+json::node::operator float() const { return this->number_as<float>(FLOAT_FORMAT); }
+json::node::operator double() const { return this->number_as<double>(DOUBLE_FORMAT); }
+
+json::jobject json::node::as_object() const
+{
+    if (!this->is_object()) throw json::parsing_error("Input is not a valid object");
+    json::jobject result(this->is_array());
+    for (size_t i = 0; i < this->size(); i++)
+    {
+        result += json::kvp(this->is_array() ? std::string() : this->key(i), this->_children[i].serialize());
+    }
+    return result;
+}
+
+std::string json::node::serialize() const
+{
+    switch (this->_type)
+    {
+    case json::jtype::jstring:
+        if (!this->_escaped.empty()) return std::string(this->_escaped.data(), this->_escaped.size());
+        return "\"" + std::string(this->_value.data(), this->_value.size()) + "\"";
+    case json::jtype::jnumber:
+        return std::string(this->_value.data(), this->_value.size());
+    case json::jtype::jbool:
+        return this->_boolean ? "true" : "false";
+    case json::jtype::jnull:
+        return "null";
+    default:
+        break;
+    }
+    if (this->size() == 0) return this->is_array() ? "[]" : "{}";
+    std::string result = this->is_array() ? "[" : "{";
+    for (size_t i = 0; i < this->size(); i++)
+    {
+        if (!this->is_array()) result += json::parsing::encode_string(this->_keys[i].c_str()) + ":";
+        result += this->_children[i].serialize() + ",";
+    }
+    result.erase(result.size() - 1, 1);
+    result += this->is_array() ? "]" : "}";
+    return result;
+}
+
+std::string json::node::pretty(unsigned int indent_level) const
+{
+    std::string result = "";
+    for(unsigned int i = 0; i < indent_level; i++) result += "\t";
+    if (!this->is_object()) {
+        result += this->serialize();
+        return result;
+    }
+    if(this->size() == 0) {
+        result += this->is_array() ? "[]" : "{}";
+        return result;
+    }
+    result += this->is_array() ? "[\n" : "{\n";
+    for (size_t i = 0; i < this->size(); i++)
+    {
+        const json::node &child = this->_children[i];
+        if (this->is_array()) {
+            if (child.is_object()) {
+                result += child.pretty(indent_level + 1);
+            } else {
+                for(unsigned int j = 0; j < indent_level + 1; j++) result += "\t";
+                result += child.serialize();
+            }
+        } else {
+            for(unsigned int j = 0; j < indent_level + 1; j++) result += "\t";
+            result += json::parsing::encode_string(this->_keys[i].c_str()) + ": ";
+            if (child.is_object()) result += json::parsing::tlws(child.pretty(indent_level + 1).c_str());
+            else result += child.serialize();
+        }
+        result += ",\n";
+    }
+    result.erase(result.size() - 2, 1);
+    for(unsigned int i = 0; i < indent_level; i++) result += "\t";
+    result += this->is_array() ? "]" : "}";
+    return result;
+}
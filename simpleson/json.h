@@ -13,6 +13,21 @@
 #include <stdexcept>
 #include <cctype>
 
+#ifndef JSON_KEY_INDEX_THRESHOLD
+/*! \brief The number of entries at which a JSON object starts indexing its keys
+ *
+ * \details Smaller objects are searched linearly. Define as 0 to always search linearly.
+ */
+#define JSON_KEY_INDEX_THRESHOLD 32
+#endif
+
+#ifdef JSON_USE_PMR
+#if __cplusplus < 201703L && !(defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#error "JSON_USE_PMR requires C++17"
+#endif
+#include <memory_resource>
+#endif
+
 /*! \brief Base namespace for simpleson */
 namespace json
 {
@@ -348,31 +363,93 @@ namespace json
 		 */
 		parse_results parse(const char *input);
 		
+		/*! \brief Converts the decimal number at the start of a string using std::from_chars
+		 *
+		 * \details The conversion ignores the locale. It is only available when json.cpp is built as C++17 with a standard library
+		 * that supports floating-point std::from_chars and std::to_chars, and JSON_NO_CHARCONV is not defined.
+		 * @param input The string to convert
+		 * @param[out] output The converted number
+		 * @return True if the number was converted. False if std::from_chars is not available, or the input is not a number that fits in the type
+		 */
+		bool number_from_chars(const char *input, int &output);
+
+		/*! @see json::parsing::number_from_chars(const char*, int&) */
+		bool number_from_chars(const char *input, unsigned int &output);
+
+		/*! @see json::parsing::number_from_chars(const char*, int&) */
+		bool number_from_chars(const char *input, long &output);
+
+		/*! @see json::parsing::number_from_chars(const char*, int&) */
+		bool number_from_chars(const char *input, unsigned long &output);
+
+		/*! @see json::parsing::number_from_chars(const char*, int&) */
+		bool number_from_chars(const char *input, float &output);
+
+		/*! @see json::parsing::number_from_chars(const char*, int&) */
+		bool number_from_chars(const char *input, double &output);
+
+		/*! \brief Fallback for types without a std::from_chars conversion, such as char */
+		template <typename T>
+		inline bool number_from_chars(const char *, T &) { return false; }
+
+		/*! \brief Converts a number to its shortest round-trip decimal representation using std::to_chars
+		 *
+		 * @param number The number to convert
+		 * @param[out] output The string representation of the number
+		 * @return True if the number was converted. False if std::to_chars is not available
+		 * @see json::parsing::number_from_chars(const char*, int&)
+		 */
+		bool number_to_chars(const int number, std::string &output);
+
+		/*! @see json::parsing::number_to_chars(const int, std::string&) */
+		bool number_to_chars(const unsigned int number, std::string &output);
+
+		/*! @see json::parsing::number_to_chars(const int, std::string&) */
+		bool number_to_chars(const long number, std::string &output);
+
+		/*! @see json::parsing::number_to_chars(const int, std::string&) */
+		bool number_to_chars(const unsigned long number, std::string &output);
+
+		/*! @see json::parsing::number_to_chars(const int, std::string&) */
+		bool number_to_chars(const float number, std::string &output);
+
+		/*! @see json::parsing::number_to_chars(const int, std::string&) */
+		bool number_to_chars(const double number, std::string &output);
+
+		/*! \brief Fallback for types without a std::to_chars conversion, such as char */
+		template <typename T>
+		inline bool number_to_chars(const T, std::string &) { return false; }
+
 		/*! \brief Template for reading a numeric value 
 		 * 
+		 * \details std::from_chars is used when available, otherwise the input is read with std::sscanf
 		 * @tparam T The C data type the input will be convered to
 		 * @param input The string to conver to a number
-		 * @param format The format to use when converting the string to a number
+		 * @param format The format to use when converting the string to a number with std::sscanf
 		 * @return The numeric value contained by the input
 		 */
 		template <typename T>
 		T get_number(const char *input, const char* format)
 		{
 			T result;
+			if (number_from_chars(input, result)) return result;
 			std::sscanf(input, format, &result);
 			return result;
 		}
 
 		/*! \brief Converts a number to a string
 		 * 
+		 * \details std::to_chars is used when available, otherwise the number is formatted with std::snprintf
 		 * @tparam The C data type of the number to be converted
 		 * @param number A reference to the number to be converted
-		 * @param format The format to be used when converting the number
+		 * @param format The format to be used when converting the number with std::snprintf
 		 * @return A string representation of the input number
 		 */ 
 		template <typename T>
 		std::string get_number_string(const T &number, const char *format)
 		{
+			std::string result;
+			if (number_to_chars(number, result)) return result;
 			std::vector<char> cstr(6);
 			int remainder = std::snprintf(&cstr[0], cstr.size(), format, number);
 			if(remainder < 0) {
@@ -381,7 +458,7 @@ namespace json
 				cstr.resize(remainder + 1);
 				std::snprintf(&cstr[0], cstr.size(), format, number);
 			}
-			std::string result(&cstr[0]);
+			result = &cstr[0];
 			return result;
 		}
 
@@ -421,6 +498,26 @@ namespace json
 		 */
 		bool array_flag;
 
+		/*! \brief Open-addressing table from key hashes to positions in the data
+		 *
+		 * \details The table is built when an object reaches JSON_KEY_INDEX_THRESHOLD entries. Each slot holds the hash of a key
+		 * and the position of its entry plus one, so zero marks an empty slot. Only the methods modifying the object update the
+		 * table, so concurrent lookups through const methods are safe, as they are for the other standard containers.
+		 */
+		std::vector<std::pair<size_t, size_t> > key_index;
+
+		/*! \brief Returns the position of the entry with the key, or size() if the object does not contain the key */
+		size_t find(const std::string &key) const;
+
+		/*! \brief Builds the key index for the current entries, or clears it if the object is too small to be indexed */
+		void build_key_index();
+
+		/*! \brief Adds the last entry to the key index, rebuilding the index if it is missing or would be more than half full */
+		void update_key_index();
+
+		/*! \brief Adds the entry at a position to a key index that has a free slot */
+		void index_key(const size_t position);
+
 	public:
 		/*! \brief Default constructor
 		 *
@@ -433,7 +530,8 @@ namespace json
 		/*! \brief Copy constructor */
 		inline jobject(const jobject &other)
 			: data(other.data),
-			array_flag(other.array_flag)
+			array_flag(other.array_flag),
+			key_index(other.key_index)
 		{ }
 
 		/*! \brief Destructor */
@@ -449,7 +547,11 @@ namespace json
 		inline size_t size() const { return this->data.size(); }
 
 		/*! \brief Clears the JSON object or array */
-		inline void clear() { this->data.resize(0); }
+		inline void clear()
+		{
+			this->data.resize(0);
+			this->key_index.clear();
+		}
 
 		/*! \brief Comparison operator
 		 *
@@ -465,6 +567,7 @@ namespace json
 		{
 			this->array_flag = rhs.array_flag;
 			this->data = rhs.data;
+			this->key_index = rhs.key_index;
 			return *this;
 		}
 
@@ -478,6 +581,7 @@ namespace json
 			if(this->array_flag && other.first != "") throw json::parsing_error("Array cannot have key");
 			if(!this->array_flag && other.first == "") throw json::parsing_error("Missing key");
 			this->data.push_back(other);
+			this->update_key_index();
 			return *this;
 		}
 
@@ -542,8 +646,7 @@ namespace json
 		inline bool has_key(const std::string &key) const
 		{
 			if(this->array_flag) return false;
-			for (size_t i = 0; i < this->size(); i++) if (this->data.at(i).first == key) return true;
-			return false;
+			return this->find(key) < this->size();
 		}
 
 		/*! \brief Returns a list of the object's keys
@@ -580,7 +683,8 @@ namespace json
 		inline std::string get(const std::string &key) const
 		{
 			if(this->array_flag) throw json::invalid_key(key);
-			for (size_t i = 0; i < this->size(); i++) if (this->data.at(i).first == key) return this->get(i);
+			const size_t position = this->find(key);
+			if (position < this->size()) return this->get(position);
 			throw json::invalid_key(key);
 		}
 
@@ -598,6 +702,7 @@ namespace json
 		void remove(const size_t index)
 		{
 			this->data.erase(this->data.begin() + index);
+			this->build_key_index();
 		}
 
 		/*! \brief Representation of a value in the object */
@@ -855,7 +960,8 @@ namespace json
 			/*! \brief Returns a reference to the value */
 			inline const std::string& ref() const 
 			{
-				for (size_t i = 0; i < this->source.size(); i++) if (this->source.data.at(i).first == key) return this->source.data.at(i).second;
+				const size_t position = this->source.find(key);
+				if (position < this->source.size()) return this->source.data.at(position).second;
 				throw json::invalid_key(key);
 			}
 
@@ -1095,6 +1201,303 @@ namespace json
 		 */
 		std::string pretty(unsigned int indent_level = 0) const;
 	};
+
+	/*! \class node
+	 * \brief A parsed JSON value stored as a tree
+	 *
+	 * \details A document is parsed once into nodes. Objects and arrays keep their children as nodes, so nested access is a
+	 * lookup per level instead of parsing the serialized child again. Strings are decoded and numbers are converted when they
+	 * are parsed, so reading a scalar does not parse its text again. json::jobject still stores its values as JSON text and
+	 * parses a child on every nested access; it remains the type used to build and edit documents.
+	 *
+	 * When JSON_USE_PMR is defined (C++17), nodes store their text and children in std::pmr containers. A document parsed with
+	 * an allocator, such as one backed by a std::pmr::monotonic_buffer_resource, then lives in the resource's blocks and is
+	 * released with the resource. JSON_USE_PMR must be defined the same way for json.cpp and every file including json.h.
+	 */
+	class node
+	{
+	public:
+#ifdef JSON_USE_PMR
+		/*! \brief The allocator used by the node and all of its children */
+		typedef std::pmr::polymorphic_allocator<char> allocator_type;
+
+		/*! \brief The string type used to store keys and values */
+		typedef std::pmr::string string_type;
+
+		/*! \brief The container used to store the keys */
+		typedef std::pmr::vector<string_type> keys_type;
+
+		/*! \brief The container used to store the children */
+		typedef std::pmr::vector<node> children_type;
+#else
+		/*! \brief The string type used to store keys and values */
+		typedef std::string string_type;
+
+		/*! \brief The container used to store the keys */
+		typedef std::vector<string_type> keys_type;
+
+		/*! \brief The container used to store the children */
+		typedef std::vector<node> children_type;
+#endif
+
+	private:
+		/*! \brief The type of the value */
+		jtype::jtype _type;
+
+		/*! \brief How the value of a number is stored */
+		enum number_kind
+		{
+			NUMBER_INTEGER, /*!< Fits in a long */
+			NUMBER_UNSIGNED, /*!< Fits in an unsigned long but not in a long */
+			NUMBER_REAL /*!< Has a fraction or an exponent, or does not fit in an integer */
+		};
+
+		/*! \brief The decoded text of a string, or the JSON text of a number */
+		string_type _value;
+
+		/*! \brief The JSON text of a string with escape sequences, which decoding does not always preserve */
+		string_type _escaped;
+
+		/*! \brief The keys of an object, in the same order as the children */
+		keys_type _keys;
+
+		/*! \brief The values of an object or an array */
+		children_type _children;
+
+		/*! \brief The value of a boolean */
+		bool _boolean;
+
+		/*! \brief The member of _number holding the value of a number */
+		number_kind _number_kind;
+
+		/*! \brief The value of a number, converted once when it is parsed */
+		union
+		{
+			long integer;
+			unsigned long uinteger;
+			double real;
+		} _number;
+
+		/*! \brief Parses a value and its children
+		 *
+		 * @param input The serialized value, leading white space is skipped
+		 * @param[out] output The node the value is parsed into
+		 * @return A pointer to the first character after the value
+		 * \exception json::parsing_error Thrown when the input is not valid JSON
+		 */
+		static const char* parse_value(const char *input, node &output);
+
+		/*! \brief Converts the value of a number without parsing its text
+		 *
+		 * \details Values that are not numbers, or that T cannot represent exactly, are converted from their text as
+		 * json::jobject does
+		 * @tparam T The C data type the value is converted to
+		 * @param format The format used when converting the text with std::sscanf
+		 */
+		template <typename T>
+		T number_as(const char *format) const;
+
+	public:
+		/*! \brief Constructs a null value */
+		inline node() : _type(jtype::jnull), _boolean(false), _number_kind(NUMBER_INTEGER) { this->_number.integer = 0; }
+
+#ifdef JSON_USE_PMR
+		/*! \brief Constructs a null value that allocates from the supplied allocator */
+		explicit inline node(const allocator_type &allocator)
+			: _type(jtype::jnull),
+			_value(allocator),
+			_escaped(allocator),
+			_keys(allocator),
+			_children(allocator),
+			_boolean(false),
+			_number_kind(NUMBER_INTEGER)
+		{
+			this->_number.integer = 0;
+		}
+
+		/*! \brief Copies a node into the supplied allocator */
+		inline node(const node &other, const allocator_type &allocator)
+			: _type(other._type),
+			_value(other._value, allocator),
+			_escaped(other._escaped, allocator),
+			_keys(other._keys, allocator),
+			_children(other._children, allocator),
+			_boolean(other._boolean),
+			_number_kind(other._number_kind),
+			_number(other._number)
+		{ }
+
+		/*! \brief Moves a node, copying its contents if the supplied allocator uses a different resource */
+		inline node(node &&other, const allocator_type &allocator)
+			: _type(other._type),
+			_value(std::move(other._value), allocator),
+			_escaped(std::move(other._escaped), allocator),
+			_keys(std::move(other._keys), allocator),
+			_children(std::move(other._children), allocator),
+			_boolean(other._boolean),
+			_number_kind(other._number_kind),
+			_number(other._number)
+		{ }
+
+		/*! \brief Returns the allocator used by the node */
+		inline allocator_type get_allocator() const { return this->_children.get_allocator(); }
+#endif
+
+		/*! \brief Builds the tree of a JSON object or array
+		 *
+		 * \details Each serialized value of the object is parsed once
+		 */
+		explicit node(const jobject &object);
+
+		/*! \brief Parses a serialized JSON value
+		 *
+		 * @param input Serialized JSON value, which may be an object, an array or a scalar
+		 * @return The root node of the tree
+		 * \exception json::parsing_error Thrown when the input is not valid JSON
+		 */
+		static node parse(const char *input);
+
+		/*! \brief Parses a serialized JSON value
+		 *
+		 * @see json::node::parse(const char*)
+		 */
+		static inline node parse(const std::string &input) { return parse(input.c_str()); }
+
+#ifdef JSON_USE_PMR
+		/*! \brief Parses a serialized JSON value into memory obtained from the supplied allocator
+		 *
+		 * \details Every key, value and child of the returned tree is allocated from the allocator's resource, so a
+		 * std::pmr::monotonic_buffer_resource holds the whole document in a few blocks. The tree must not outlive the resource.
+		 * @see json::node::parse(const char*)
+		 */
+		static node parse(const char *input, const allocator_type &allocator);
+
+		/*! \brief Parses a serialized JSON value into memory obtained from the supplied allocator
+		 *
+		 * @see json::node::parse(const char*, const allocator_type&)
+		 */
+		static inline node parse(const std::string &input, const allocator_type &allocator) { return parse(input.c_str(), allocator); }
+#endif
+
+		/*! \brief Returns the type of the value */
+		inline jtype::jtype type() const { return this->_type; }
+
+		/*! \brief Returns the number of entries in an object or array, or zero for scalars */
+		inline size_t size() const { return this->_children.size(); }
+
+		/*! \brief Determines if an object contains a key
+		 *
+		 * \note If the node is not an object, then this function will always return false
+		 */
+		bool has_key(const std::string &key) const;
+
+		/*! \brief Returns a list of the object's keys, or an empty list if the node is not an object */
+		key_list_t list_keys() const;
+
+		/*! \brief Returns the key of an object entry
+		 *
+		 * @param index The index of the entry
+		 */
+		inline std::string key(const size_t index) const { return std::string(this->_keys.at(index).data(), this->_keys.at(index).size()); }
+
+		/*! \brief Returns the value associated with a key
+		 *
+		 * \details If the key is duplicated, then the first value is returned
+		 * \exception json::invalid_key Thrown if the key does not exist or the node is not an object
+		 */
+		const node& operator[](const std::string &key) const;
+
+		/*! \brief Returns the value associated with a key
+		 *
+		 * @see json::node::operator[](const std::string&) const
+		 */
+		inline const node& operator[](const char *key) const { return this->operator[](std::string(key)); }
+
+		/*! \brief Returns the value at an index of an array or object
+		 *
+		 * \exception std::out_of_range Thrown if the index is not valid
+		 */
+		inline const node& operator[](const size_t index) const { return this->_children.at(index); }
+
+		/*! \brief Returns the value at an index of an array or object
+		 *
+		 * @see json::node::operator[](const size_t) const
+		 */
+		inline const node& operator[](const int index) const { return this->_children.at(index); }
+
+		/*! \brief Returns true if the value is a string */
+		inline bool is_string() const { return this->_type == jtype::jstring; }
+
+		/*! \brief Returns true if the value is a number */
+		inline bool is_number() const { return this->_type == jtype::jnumber; }
+
+		/*! \brief Returns true if the value is an object or an array */
+		inline bool is_object() const { return this->_type == jtype::jobject || this->_type == jtype::jarray; }
+
+		/*! \brief Returns true if the value is an array */
+		inline bool is_array() const { return this->_type == jtype::jarray; }
+
+		/*! \brief Returns true if the value is a bool */
+		inline bool is_bool() const { return this->_type == jtype::jbool; }
+
+		/*! \brief Returns true if the value is a boolean and set to true */
+		inline bool is_true() const { return this->_type == jtype::jbool && this->_boolean; }
+
+		/*! \brief Returns true if the value is a null value */
+		inline bool is_null() const { return this->_type == jtype::jnull; }
+
+		/*! \brief Returns a string representation of the value
+		 *
+		 * \details Strings are decoded, other values are serialized
+		 */
+		std::string as_string() const;
+
+		/*! @see json::node::as_string() */
+		inline operator std::string() const { return this->as_string(); }
+
+		/*! \brief Comparison operator */
+		bool operator== (const std::string other) const { return this->as_string() == other; }
+
+		/*! \brief Comparison operator */
+		bool operator!= (const std::string other) const { return this->as_string() != other; }
+
+		/*! \brief Casts the value as an integer */
+		operator int() const;
+
+		/*! \brief Casts the value as an unsigned integer */
+		operator unsigned int() const;
+
+		/*! \brief Casts the value as a long integer */
+		operator long() const;
+
+		/*! \brief Casts the value as an unsigned long integer */
+		operator unsigned long() const;
+
+		/*! \brief Casts the value as a floating point number */
+		operator float() const;
+
+		/*! \brief Casts the value as a double-precision floating point number */
+		operator double() const;
+
+		/*! \brief Converts an object or an array to a json::jobject
+		 *
+		 * \exception json::parsing_error Thrown if the node is not an object or an array
+		 */
+		jobject as_object() const;
+
+		/*! @see json::node::as_object() */
+		inline operator jobject() const { return this->as_object(); }
+
+		/*! \brief Serializes the value in the most compact form */
+		std::string serialize() const;
+
+		/*! \brief Returns a pretty (multi-line indented) serialized representation of the value
+		 *
+		 * @param indent_level The number of indents (tabs) to start with
+		 * @see json::jobject::pretty()
+		 */
+		std::string pretty(unsigned int indent_level = 0) const;
+	};
 }
 
 #endif // !JSON_H
\ No newline at end of file
@@ -0,0 +1,96 @@
+#include "json.h"
+#include "test.h"
+
+int main(void)
+{
+	const char *input = "{\"name\": \"hello \\\"world\\\"\", \"count\": 42, \"ratio\": -1.5e2, \"flags\": [true, false, null],"
+		" \"nested\": {\"inner\": [{\"id\": 7}, \"text\"]}, \"empty\": {}}";
+
+	json::node doc = json::node::parse(input);
+	TEST_TRUE(doc.is_object());
+	TEST_FALSE(doc.is_array());
+	TEST_EQUAL(doc.size(), 6);
+	TEST_TRUE(doc.has_key("nested"));
+	TEST_FALSE(doc.has_key("missing"));
+	TEST_EQUAL(doc.list_keys().size(), 6);
+	TEST_STRING_EQUAL(doc.key(1).c_str(), "count");
+
+	// Scalars
+	TEST_TRUE(doc["name"].is_string());
+	TEST_STRING_EQUAL(doc["name"].as_string().c_str(), "hello \"world\"");
+	TEST_TRUE(doc["count"].is_number());
+	TEST_EQUAL((int)doc["count"], 42);
+	TEST_EQUAL((unsigned long)doc["count"], 42);
+	TEST_EQUAL((double)doc["ratio"], -150.0);
+	TEST_TRUE(doc["flags"].is_array());
+	TEST_TRUE(doc["flags"][0].is_true());
+	TEST_TRUE(doc["flags"][1].is_bool());
+	TEST_FALSE(doc["flags"][1].is_true());
+	TEST_TRUE(doc["flags"][2].is_null());
+
+	// Nested access
+	TEST_EQUAL((int)doc["nested"]["inner"][0]["id"], 7);
+	TEST_STRING_EQUAL(doc["nested"]["inner"][1].as_string().c_str(), "text");
+	TEST_EQUAL(doc["empty"].size(), 0);
+
+	// Serialization
+	TEST_STRING_EQUAL(doc["nested"].serialize().c_str(), "{\"inner\":[{\"id\":7},\"text\"]}");
+	TEST_STRING_EQUAL(doc["flags"].as_string().c_str(), "[true,false,null]");
+	json::jobject obj = json::jobject::parse(input);
+	TEST_STRING_EQUAL(doc.serialize().c_str(), obj.as_string().c_str());
+	TEST_STRING_EQUAL(json::node(obj).serialize().c_str(), obj.as_string().c_str());
+	TEST_STRING_EQUAL(doc.as_object().as_string().c_str(), obj.as_string().c_str());
+	TEST_STRING_EQUAL(doc.pretty().c_str(), obj.pretty().c_str());
+
+	// Numbers are converted and strings decoded once, the JSON text of numbers and escaped strings is kept
+	const char *typed_input = "[4294967295,-2147483648,2.75,-7,\"a\\/b\\tc\\u0041\",\"plain\",true,null]";
+	json::node typed = json::node::parse(typed_input);
+	TEST_EQUAL((unsigned int)typed[0], 4294967295u);
+	TEST_EQUAL((long)typed[1], -2147483648L);
+	TEST_EQUAL((int)typed[2], 2);
+	TEST_EQUAL((double)typed[2], 2.75);
+	TEST_EQUAL((float)typed[2], 2.75f);
+	TEST_EQUAL((int)typed[3], -7);
+	TEST_EQUAL((float)typed[3], -7.0f);
+	TEST_STRING_EQUAL(typed[4].as_string().substr(0, 5).c_str(), "a/b\tc");
+	TEST_STRING_EQUAL(typed[4].serialize().c_str(), "\"a\\/b\\tc\\u0041\"");
+	TEST_STRING_EQUAL(typed[5].serialize().c_str(), "\"plain\"");
+	TEST_STRING_EQUAL(typed[6].serialize().c_str(), "true");
+	TEST_STRING_EQUAL(typed[7].serialize().c_str(), "null");
+	TEST_STRING_EQUAL(typed.serialize().c_str(), typed_input);
+
+	// Keys are stored decoded and must be encoded again when printed
+	json::node escaped = json::node::parse("{\"k\\\"q\":{\"x\\\\y\\n\":1,\"plain\":[true]}}");
+	TEST_STRING_EQUAL(escaped.key(0).c_str(), "k\"q");
+	TEST_STRING_EQUAL(json::node::parse(escaped.pretty()).serialize().c_str(), escaped.serialize().c_str());
+
+	// Errors
+	bool thrown = false;
+	try { doc["missing"]; } catch (const json::invalid_key &) { thrown = true; }
+	TEST_TRUE(thrown);
+	thrown = false;
+	try { doc["count"]["missing"]; } catch (const json::invalid_key &) { thrown = true; }
+	TEST_TRUE(thrown);
+	const char *invalid[] = { "{\"a\" 1}", "[1,]", "{\"a\":1,}", "[\"open", "[01]", "[1.]", "[tru]", "  ", "\"\\x\"" };
+	for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++)
+	{
+		thrown = false;
+		try { json::node::parse(invalid[i]); } catch (const json::parsing_error &) { thrown = true; }
+		TEST_TRUE(thrown);
+	}
+
+#ifdef JSON_USE_PMR
+	// The whole document must fit in the buffer since the upstream resource refuses to allocate
+	char buffer[1 << 16];
+	std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+	json::node pooled = json::node::parse(input, &arena);
+	TEST_TRUE(pooled.get_allocator().resource() == &arena);
+	TEST_TRUE(pooled["nested"]["inner"][0].get_allocator().resource() == &arena);
+	TEST_STRING_EQUAL(pooled.serialize().c_str(), doc.serialize().c_str());
+	TEST_STRING_EQUAL(pooled.key(4).c_str(), "nested");
+	TEST_EQUAL((int)pooled["nested"]["inner"][0]["id"], 7);
+	json::node copy = pooled["nested"];
+	TEST_TRUE(copy.get_allocator().resource() == std::pmr::get_default_resource());
+	TEST_STRING_EQUAL(copy.serialize().c_str(), "{\"inner\":[{\"id\":7},\"text\"]}");
+#endif
+}
@@ -0,0 +1,59 @@
+#include "json.h"
+#include "test.h"
+
+int main(void)
+{
+	// Large enough for the object to index its keys
+	const int count = 1000;
+	char key[32];
+	json::jobject test;
+	for (int i = 0; i < count; i++)
+	{
+		snprintf(key, sizeof(key), "key%d", i);
+		test[key] = i;
+	}
+	TEST_EQUAL(test.size(), count);
+	for (int i = 0; i < count; i++)
+	{
+		snprintf(key, sizeof(key), "key%d", i);
+		TEST_TRUE(test.has_key(key));
+		TEST_EQUAL((int)test[key], i);
+	}
+	TEST_FALSE(test.has_key("missing"));
+
+	// Updating a key keeps its position
+	test["key10"] = "updated";
+	TEST_EQUAL(test.size(), count);
+	TEST_STRING_EQUAL(test.list_keys().at(10).c_str(), "key10");
+	TEST_STRING_EQUAL(test["key10"].as_string().c_str(), "updated");
+
+	// Removing entries shifts the following positions
+	test.remove("key0");
+	test.remove(499);
+	TEST_EQUAL(test.size(), count - 2);
+	TEST_FALSE(test.has_key("key0"));
+	TEST_FALSE(test.has_key("key500"));
+	TEST_EQUAL((int)test["key999"], 999);
+	TEST_STRING_EQUAL(test.list_keys().front().c_str(), "key1");
+
+	// Appending after a removal
+	json::kvp entry("appended", "1");
+	test += entry;
+	TEST_EQUAL((int)test["appended"], 1);
+	TEST_STRING_EQUAL(test.list_keys().back().c_str(), "appended");
+	bool thrown = false;
+	try { test += entry; } catch (const json::parsing_error &) { thrown = true; }
+	TEST_TRUE(thrown);
+
+	// Parsing, copying and assignment
+	json::jobject parsed = json::jobject::parse(test.as_string());
+	TEST_STRING_EQUAL(parsed.as_string().c_str(), test.as_string().c_str());
+	TEST_EQUAL((int)parsed["key998"], 998);
+	json::jobject assigned;
+	assigned = parsed;
+	TEST_EQUAL((int)assigned["key1"], 1);
+	assigned.clear();
+	TEST_FALSE(assigned.has_key("key1"));
+	assigned["key1"] = 2;
+	TEST_EQUAL((int)assigned["key1"], 2);
+}
@@ -0,0 +1,47 @@
+#include "json.h"
+#include "test.h"
+#include <limits.h>
+
+int main(void)
+{
+	json::jobject test;
+	test["int_min"] = INT_MIN;
+	test["int_max"] = INT_MAX;
+	test["uint_max"] = UINT_MAX;
+	test["long_min"] = LONG_MIN;
+	test["ulong_max"] = ULONG_MAX;
+	test["double"] = 123.456;
+	test["small"] = -1.5e-300;
+	test["float"] = 0.1f;
+
+	// Every value must be serialized as a JSON number
+	json::jobject retest = json::jobject::parse(test.as_string());
+	json::key_list_t keys = retest.list_keys();
+	for (size_t i = 0; i < keys.size(); i++) TEST_TRUE(retest[keys[i]].is_number());
+
+	TEST_EQUAL((int)retest["int_min"], INT_MIN);
+	TEST_EQUAL((int)retest["int_max"], INT_MAX);
+	TEST_EQUAL((unsigned int)retest["uint_max"], UINT_MAX);
+	TEST_EQUAL((long)retest["long_min"], LONG_MIN);
+	TEST_EQUAL((unsigned long)retest["ulong_max"], ULONG_MAX);
+	TEST_EQUAL((double)retest["double"], 123.456);
+	TEST_EQUAL((double)retest["small"], -1.5e-300);
+	TEST_EQUAL((float)retest["float"], 0.1f);
+	TEST_STRING_EQUAL(retest.get("int_min").c_str(), "-2147483648");
+
+	// Arrays of numbers
+	std::vector<double> doubles;
+	doubles.push_back(0.5);
+	doubles.push_back(-2.25);
+	doubles.push_back(1e10);
+	test["doubles"] = doubles;
+	std::vector<double> doubles_out = test["doubles"];
+	TEST_EQUAL(doubles_out.size(), 3);
+	TEST_EQUAL(doubles_out[0], 0.5);
+	TEST_EQUAL(doubles_out[1], -2.25);
+	TEST_EQUAL(doubles_out[2], 1e10);
+
+	// Integers read from numbers with a fraction or an exponent keep the leading digits
+	TEST_EQUAL((int)json::jobject::parse("{\"value\":12.75}")["value"], 12);
+	TEST_EQUAL((double)json::jobject::parse("{\"value\":2.5e3}")["value"], 2500.0);
+}
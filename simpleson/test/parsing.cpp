@@ -55,4 +55,25 @@ int main(void)
         TEST_STRING_EQUAL(stream.readout().c_str(), data_point);
         stream.clear();
     }
-}
\ No newline at end of file
+
+    // Bulk parsing must match the incremental reader
+    for(i = 0; i < data_points; i++) {
+        const json::parsing::parse_results result = json::parsing::parse(test_data[i].input);
+        TEST_EQUAL(result.type, test_data[i].type);
+        TEST_STRING_EQUAL(result.value.c_str(), test_data[i].output);
+        TEST_TRUE(*result.remainder == '\0');
+    }
+    for(i = 0; i < num_num; i++) {
+        const json::parsing::parse_results result = json::parsing::parse(test_numbers[i]);
+        TEST_EQUAL(result.type, json::jtype::jnumber);
+        TEST_STRING_EQUAL(result.value.c_str(), test_numbers[i]);
+    }
+    const json::parsing::parse_results spaced = json::parsing::parse(
+        " {\n\t\"a long key with \\\"escapes\\\" and \\/ more\" :\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t[ 1 , \"x\" ]\r\n} tail");
+    TEST_EQUAL(spaced.type, json::jtype::jobject);
+    TEST_STRING_EQUAL(spaced.value.c_str(), "{\"a long key with \\\"escapes\\\" and \\/ more\":[1,\"x\"]}");
+    TEST_STRING_EQUAL(spaced.remainder, " tail");
+    TEST_EQUAL(json::parsing::parse("[1,]").type, json::jtype::not_valid);
+    TEST_EQUAL(json::parsing::parse("[\"open").type, json::jtype::not_valid);
+    TEST_EQUAL(json::parsing::parse("\"bad \\q\"").type, json::jtype::not_valid);
+}
@@ -57,4 +57,9 @@ int main(void)
 	// Test copy constructor
 	json::jobject copy(result);
 	TEST_STRING_EQUAL(copy.as_string().c_str(), result.as_string().c_str());
+
+	// Values which are not valid JSON are printed as they are stored
+	json::jobject invalid;
+	invalid["x"] = nan("");
+	TEST_STRING_EQUAL(invalid.pretty().c_str(), "{\n\t\"x\": nan\n}");
 }
\ No newline at end of file